@@ -0,0 +1,10 @@
+TEMPLATE = subdirs
+
+SUBDIRS += core \
+           timeLine \
+           bench \
+           tests
+
+timeLine.depends = core
+bench.depends = core
+tests.depends = core
@@ -0,0 +1,19 @@
+QT += core gui widgets testlib
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = bench_core
+
+# VisualMap 為主程式的 header-only Widget，其餘受測函式來自 core
+INCLUDEPATH += ../timeLine
+
+SOURCES += bench_core.cpp \
+           ../timeLine/PerfMetrics.cpp \
+           ../timeLine/Trace.cpp
+
+HEADERS += ../timeLine/VisualMap.h
+
+include(../core/core.pri)
+
+# 固定資料集
+DEFINES += BENCH_DATA_DIR=\\\"$$PWD/data\\\"
@@ -0,0 +1,257 @@
+#include <QtTest>
+#include <QBuffer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include "Trajectory.h"
+#include "CameraPathPlanner.h"
+#include "VisualMap.h"
+
+/**
+ * @brief BenchCore
+ * 基礎函式的微基準測試 (QBENCHMARK)
+ *
+ * 資料集：bench/data 內提交的 1k、10k 筆軌跡 (make_datasets.py 產生)，
+ * 100k 由 10k 依時間平移重複十次組成。所有隨機輸入都使用固定種子，
+ * 每次執行的工作量完全相同，結果可以前後比較。
+ *
+ * 執行：bench_core -median 5 (或 -tickcounter 取 CPU 週期)
+ */
+class BenchCore : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void parseCsv_data();
+    void parseCsv();
+    void parseCsvLegacy_data();
+    void parseCsvLegacy();
+
+    void lookupSequential_data();
+    void lookupSequential();
+    void lookupRandom_data();
+    void lookupRandom();
+
+    void cropClip();
+    void mapPoint();
+
+    void planCameraPath_data();
+    void planCameraPath();
+
+private:
+    void addSizes();
+    QByteArray m_csv[3];                ///< 1k / 10k / 100k 的 CSV 內容 (已讀入記憶體)
+    QVector<DataPoint> m_points[3];     ///< 解析後的軌跡
+};
+
+// -------------------------
+// 資料集
+// -------------------------
+void BenchCore::initTestCase()
+{
+    const char *files[] = { "trajectory_1k.csv", "trajectory_10k.csv" };
+    for (int i = 0; i < 2; ++i) {
+        QFile f(QString(BENCH_DATA_DIR) + "/" + files[i]);
+        QVERIFY2(f.open(QIODevice::ReadOnly), qPrintable(f.fileName()));
+        m_csv[i] = f.readAll();
+    }
+
+    // 100k：10k 資料集每次平移整段長度，重複十次
+    QBuffer source(&m_csv[1]);
+    source.open(QIODevice::ReadOnly);
+    const QVector<DataPoint> base = parseTrajectoryCsv(&source);
+    QVERIFY(!base.isEmpty());
+    const double span = base.last().time;
+
+    QTextStream out(&m_csv[2]);
+    out << "time_sec,x,y,w,h,carried\n";
+    for (int r = 0; r < 10; ++r) {
+        for (const DataPoint &d : base) {
+            out << QString::number(d.time + r * span, 'f', 3) << ',' << d.x << ',' << d.y
+                << ',' << d.w << ',' << d.h << ",0\n";
+        }
+    }
+    out.flush();
+
+    for (int i = 0; i < 3; ++i) {
+        QBuffer buffer(&m_csv[i]);
+        buffer.open(QIODevice::ReadOnly);
+        m_points[i] = parseTrajectoryCsv(&buffer);
+    }
+    QCOMPARE(m_points[0].size(), 1000);
+    QCOMPARE(m_points[1].size(), 10000);
+    QCOMPARE(m_points[2].size(), 100000);
+}
+
+void BenchCore::addSizes()
+{
+    QTest::addColumn<int>("dataset");
+    QTest::newRow("1k") << 0;
+    QTest::newRow("10k") << 1;
+    QTest::newRow("100k") << 2;
+}
+
+// -------------------------
+// CSV 解析
+// -------------------------
+void BenchCore::parseCsv_data() { addSizes(); }
+
+void BenchCore::parseCsv()
+{
+    QFETCH(int, dataset);
+    QVector<DataPoint> points;
+    QBENCHMARK {
+        QBuffer buffer(&m_csv[dataset]);
+        buffer.open(QIODevice::ReadOnly);
+        points = parseTrajectoryCsv(&buffer);
+    }
+    QCOMPARE(points.size(), m_points[dataset].size());
+}
+
+void BenchCore::parseCsvLegacy_data() { addSizes(); }
+
+/**
+ * @brief 原本 loadCSV 的寫法 (QTextStream + split)，作為比較基準
+ */
+void BenchCore::parseCsvLegacy()
+{
+    QFETCH(int, dataset);
+    QVector<DataPoint> points;
+    QBENCHMARK {
+        QBuffer buffer(&m_csv[dataset]);
+        buffer.open(QIODevice::ReadOnly);
+        QTextStream in(&buffer);
+        points.clear();
+        while (!in.atEnd()) {
+            auto s = in.readLine().split(",");
+            if (s.size() >= 3) {
+                DataPoint d = { s[0].toDouble(), s[1].toDouble(), s[2].toDouble() };
+                points.append(d);
+            }
+        }
+    }
+    QVERIFY(points.size() >= m_points[dataset].size());
+}
+
+// -------------------------
+// 時間 → 位置查詢
+// -------------------------
+void BenchCore::lookupSequential_data() { addSizes(); }
+
+void BenchCore::lookupSequential()
+{
+    QFETCH(int, dataset);
+    const QVector<DataPoint> &points = m_points[dataset];
+    const double end = points.last().time;
+
+    // 以 60fps 播放整段的查詢序列
+    double sum = 0;
+    QBENCHMARK {
+        for (double t = 0; t <= end; t += 1.0 / 60.0) {
+            sum += sampleTrajectory(points, t).x();
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+void BenchCore::lookupRandom_data() { addSizes(); }
+
+void BenchCore::lookupRandom()
+{
+    QFETCH(int, dataset);
+    const QVector<DataPoint> &points = m_points[dataset];
+
+    // 模擬跳轉：固定種子的隨機時間
+    QRandomGenerator rng(42);
+    QVector<double> times(10000);
+    for (double &t : times) t = rng.bounded(points.last().time);
+
+    double sum = 0;
+    QBENCHMARK {
+        for (double t : times) sum += sampleTrajectory(points, t).x();
+    }
+    QVERIFY(sum != 0);
+}
+
+// -------------------------
+// 輸出時的裁切區域求交集
+// -------------------------
+void BenchCore::cropClip()
+{
+    // 約一半完全在影格內，其餘跨越邊界或完全在外
+    QRandomGenerator rng(7);
+    QVector<QRect> rois(10000);
+    for (QRect &roi : rois) {
+        roi = QRect(rng.bounded(-800, 2400), rng.bounded(-500, 1400), 1067, 600);
+    }
+
+    const QSize frame(1920, 1080);
+    qint64 area = 0;
+    QBENCHMARK {
+        for (const QRect &roi : rois) {
+            const CropClip clip = clipCropRect(roi, frame);
+            area += qint64(clip.source.width()) * clip.source.height();
+        }
+    }
+    QVERIFY(area > 0);
+}
+
+// -------------------------
+// VisualMap 座標映射
+// -------------------------
+void BenchCore::mapPoint()
+{
+    const QVector<DataPoint> &points = m_points[2];
+    const QSize source(1920, 1080);
+    const QRect mapRect(30, 30, 640, 360);
+
+    qint64 sum = 0;
+    QBENCHMARK {
+        for (const DataPoint &d : points) {
+            const QPoint p = VisualMap::mapPoint(d.x, d.y, source, mapRect);
+            sum += p.x() + p.y();
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+// -------------------------
+// 鏡頭路徑規劃 (整段軌跡 → 逐幀裁切區域)
+// -------------------------
+void BenchCore::planCameraPath_data()
+{
+    QTest::addColumn<int>("dataset");
+    QTest::addColumn<bool>("autoZoom");
+    const char *names[] = { "1k", "10k", "100k" };
+    for (int i = 0; i < 3; ++i) {
+        QTest::newRow(names[i]) << i << false;
+        QTest::newRow(qPrintable(QString("%1/autoZoom").arg(names[i]))) << i << true;
+    }
+}
+
+void BenchCore::planCameraPath()
+{
+    QFETCH(int, dataset);
+    QFETCH(bool, autoZoom);
+    const QVector<DataPoint> &points = m_points[dataset];
+
+    CameraPathParams params;
+    params.autoZoom = autoZoom;
+    params.roiSize = QSizeF(1067, 600);
+    params.frameSize = QSize(1920, 1080);
+    params.fps = 30.0;
+    params.deadZone = 0.08;
+    params.maxVelocity = 1500;
+    params.maxAcceleration = 6000;
+    const int frames = qCeil(points.last().time * params.fps) + 1;
+
+    CameraPath path;
+    QBENCHMARK {
+        path = CameraPathPlanner::plan(points, params, frames);
+    }
+    QCOMPARE(path.frameCount(), frames);
+}
+
+QTEST_MAIN(BenchCore)
+#include "bench_core.moc"
@@ -0,0 +1,35 @@
+"""
+產生微基準測試用的固定軌跡資料集 (格式與 track/track.py 輸出相同)
+
+資料以固定公式產生，重新執行會得到位元組完全相同的檔案；
+平常直接使用已提交的 CSV，只有需要新增尺寸時才執行此腳本。
+"""
+import math
+import os
+
+SIZES = {'trajectory_1k.csv': 1_000, 'trajectory_10k.csv': 10_000}
+FPS = 30.0
+
+
+def write_dataset(path, rows):
+    with open(path, 'w', newline='') as f:
+        f.write('time_sec,x,y,w,h,carried\n')
+        for i in range(rows):
+            t = (i + 1) / FPS
+            # 兩個不同週期的擺動疊加，模擬人物在 1920x1080 畫面中來回走動
+            x = 960 + 620 * math.sin(i / 97.0) + 140 * math.sin(i / 13.0)
+            y = 560 + 260 * math.sin(i / 53.0) + 60 * math.cos(i / 7.0)
+            w = 90 + 30 * math.sin(i / 41.0)
+            h = 200 + 60 * math.sin(i / 41.0)
+            carried = 1 if i % 4 == 3 else 0
+            f.write(f'{t:.3f},{int(x)},{int(y)},{int(w)},{int(h)},{carried}\n')
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    for name, rows in SIZES.items():
+        write_dataset(os.path.join(here, name), rows)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,187 @@
+#include "CameraPathPlanner.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief 單軸鏡頭跟隨：死區外的偏移才移動，速度受最大速度、加速度與煞車距離限制
+ * @param camera 目前鏡頭中心 (更新)
+ * @param velocity 目前速度 (更新，像素/秒)
+ */
+void follow(double target, double deadZone, const CameraPathParams &p, double dt,
+            double &camera, double &velocity)
+{
+    const double offset = target - camera;
+    const double excess = std::abs(offset) - deadZone;
+    const double distance = excess > 0 ? std::copysign(excess, offset) : 0.0;
+
+    double desired = distance / dt;
+    if (p.maxVelocity > 0) desired = qBound(-p.maxVelocity, desired, p.maxVelocity);
+    if (p.maxAcceleration > 0) {
+        // 在剩餘距離內要能停下來，避免加速度限制造成來回震盪
+        const double brake = std::sqrt(2.0 * p.maxAcceleration * std::abs(distance));
+        desired = qBound(-brake, desired, brake);
+        const double dv = p.maxAcceleration * dt;
+        desired = qBound(velocity - dv, desired, velocity + dv);
+    }
+
+    velocity = desired;
+    camera += velocity * dt;
+}
+
+/**
+ * @brief 由逐幀人物框高度產生逐幀 ROI 高度 (關鍵點取中位數 → 零相位平滑 → 線性內插)
+ * @param boxH 逐幀人物框高度 (0 表示無資料)
+ * @param roiH 輸出逐幀 ROI 高度
+ */
+void zoomCurve(const QVector<double> &boxH, const CameraPathParams &p, double frameH, QVector<float> &roiH)
+{
+    const int n = boxH.size();
+    const int step = qMax(1, qRound(p.zoomKeyInterval * p.fps));
+    const int keyCount = (n - 1) / step + 1;
+
+    // 關鍵點：窗口內有效高度的中位數，抑制偵測框單幀抖動
+    QVector<double> keys(keyCount, 0.0);
+    QVector<double> window;
+    window.reserve(step + 1);
+    for (int k = 0; k < keyCount; ++k) {
+        const int center = k * step;
+        window.clear();
+        for (int i = qMax(0, center - step / 2); i <= qMin(n - 1, center + step / 2); ++i)
+            if (boxH[i] > 0) window.append(boxH[i]);
+        if (window.isEmpty()) continue;
+        auto mid = window.begin() + window.size() / 2;
+        std::nth_element(window.begin(), mid, window.end());
+        keys[k] = *mid;
+    }
+
+    // 無資料的關鍵點沿用前一個 (開頭則取第一個有效值)
+    double carry = 0;
+    for (double v : keys) if (v > 0) { carry = v; break; }
+    if (carry <= 0) {
+        roiH.clear();
+        return;
+    }
+    for (double &v : keys) {
+        if (v > 0) carry = v;
+        else v = carry;
+    }
+
+    // 前後向指數平滑
+    if (p.zoomSmoothing > 0 && keyCount > 1) {
+        const double alpha = 1.0 - std::exp(-(step / p.fps) / p.zoomSmoothing);
+        for (int k = 1; k < keyCount; ++k) keys[k] += (1.0 - alpha) * (keys[k - 1] - keys[k]);
+        for (int k = keyCount - 2; k >= 0; --k) keys[k] += (1.0 - alpha) * (keys[k + 1] - keys[k]);
+    }
+
+    const double lo = p.minRoiHeight > 0 ? p.minRoiHeight : 1.0;
+    const double hi = p.maxRoiHeight > 0 ? p.maxRoiHeight : (frameH > 0 ? frameH : std::numeric_limits<double>::max());
+    const double fill = p.subjectFill > 0 ? p.subjectFill : 1.0;
+
+    roiH.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const int k = i / step;
+        const double f = double(i - k * step) / step;
+        const double a = keys[k];
+        const double b = keys[qMin(k + 1, keyCount - 1)];
+        roiH[i] = float(qBound(lo, (a + (b - a) * f) / fill, qMax(lo, hi)));
+    }
+}
+
+} // namespace
+
+CameraPath CameraPathPlanner::plan(const QVector<DataPoint> &points, const CameraPathParams &params,
+                                   int frameCount)
+{
+    CameraPath path;
+    path.m_fps = params.fps;
+    if (points.isEmpty() || frameCount <= 0 || params.fps <= 0 || params.roiSize.isEmpty()) return path;
+
+    const int n = frameCount;
+    const double dt = 1.0 / params.fps;
+    const float w = float(params.roiSize.width());
+    const float h = float(params.roiSize.height());
+
+    path.m_x.resize(n);
+    path.m_y.resize(n);
+    path.m_w.fill(w, n);
+    path.m_h.fill(h, n);
+
+    // 1️⃣ 重新取樣：影格時間遞增，軌跡指標只往前走
+    QVector<double> cx(n), cy(n), boxH;
+    if (params.autoZoom) boxH.resize(n);
+    int j = 0;
+    const int last = points.size() - 1;
+    for (int i = 0; i < n; ++i) {
+        const double t = i * dt;
+        while (j < last && points[j + 1].time <= t) ++j;
+
+        if (t <= points[0].time || j == last) {
+            const DataPoint &d = (t <= points[0].time) ? points[0] : points[last];
+            cx[i] = d.x;
+            cy[i] = d.y;
+            if (params.autoZoom) boxH[i] = d.h;
+        } else {
+            const DataPoint &a = points[j];
+            const DataPoint &b = points[j + 1];
+            const double f = (t - a.time) / (b.time - a.time);
+            cx[i] = a.x + (b.x - a.x) * f;
+            cy[i] = a.y + (b.y - a.y) * f;
+            // 任一端沒有人物框時不內插，交給關鍵點補值
+            if (params.autoZoom) boxH[i] = (a.h > 0 && b.h > 0) ? a.h + (b.h - a.h) * f : qMax(a.h, b.h);
+        }
+    }
+
+    // 1.5 自動縮放：逐幀 ROI 大小 (沒有人物框資料時維持固定大小)
+    if (params.autoZoom) {
+        QVector<float> roiH;
+        zoomCurve(boxH, params, params.frameSize.height(), roiH);
+        if (!roiH.isEmpty()) {
+            const float aspect = w / h;
+            path.m_h = roiH;
+            for (int i = 0; i < n; ++i) path.m_w[i] = path.m_h[i] * aspect;
+        }
+    }
+    const float *pw = path.m_w.constData();
+    const float *ph = path.m_h.constData();
+
+    // 2️⃣ 運動限制 (第一張影格直接對準人物)
+    double camX = cx[0], camY = cy[0], velX = 0, velY = 0;
+    for (int i = 0; i < n; ++i) {
+        if (i > 0) {
+            follow(cx[i], params.deadZone * pw[i], params, dt, camX, velX);
+            follow(cy[i], params.deadZone * ph[i], params, dt, camY, velY);
+        }
+        cx[i] = camX;
+        cy[i] = camY;
+    }
+
+    // 3️⃣ 中心 → 左上角，並限制在影格內
+    float *px = path.m_x.data();
+    float *py = path.m_y.data();
+    const double *sx = cx.constData();
+    const double *sy = cy.constData();
+    if (params.clampToFrame && params.frameSize.isValid()) {
+        const float fw = float(params.frameSize.width());
+        const float fh = float(params.frameSize.height());
+        for (int i = 0; i < n; ++i) {
+            // ROI 比影格大時固定置中 (兩側補黑邊)
+            const float loX = std::min(0.0f, (fw - pw[i]) / 2), hiX = std::max(fw - pw[i], loX);
+            const float loY = std::min(0.0f, (fh - ph[i]) / 2), hiY = std::max(fh - ph[i], loY);
+            px[i] = std::clamp(float(sx[i]) - pw[i] / 2, loX, hiX);
+            py[i] = std::clamp(float(sy[i]) - ph[i] / 2, loY, hiY);
+        }
+    } else {
+        for (int i = 0; i < n; ++i) {
+            px[i] = float(sx[i]) - pw[i] / 2;
+            py[i] = float(sy[i]) - ph[i] / 2;
+        }
+    }
+
+    path.m_maxSize = QSizeF(*std::max_element(path.m_w.cbegin(), path.m_w.cend()),
+                            *std::max_element(path.m_h.cbegin(), path.m_h.cend()));
+    return path;
+}
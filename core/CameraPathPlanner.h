@@ -0,0 +1,95 @@
+#ifndef CAMERAPATHPLANNER_H
+#define CAMERAPATHPLANNER_H
+
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QVector>
+#include "Trajectory.h"
+
+/**
+ * @brief CameraPathParams
+ * 鏡頭路徑規劃參數 (原始影片座標、秒)
+ */
+struct CameraPathParams {
+    QSizeF roiSize;                 ///< 裁切區域大小 (自動縮放時只取長寬比)
+    QSize frameSize;                ///< 影格尺寸 (限制邊界用)
+    double fps = 30.0;              ///< 影格率
+    double deadZone = 0.0;          ///< 死區：人物偏離中心不超過 ROI 寬高的此比例時鏡頭不動 (0 表示永遠置中)
+    double maxVelocity = 0.0;       ///< 鏡頭最大速度 (像素/秒，0 表示不限制)
+    double maxAcceleration = 0.0;   ///< 鏡頭最大加速度 (像素/秒²，0 表示不限制)
+    bool clampToFrame = true;       ///< 裁切區域不超出影格 (ROI 比影格大時置中)
+
+    bool autoZoom = false;          ///< 依人物框高度決定逐幀 ROI 大小
+    double subjectFill = 0.45;      ///< 自動縮放：人物框高度佔 ROI 高度的比例
+    double zoomKeyInterval = 0.5;   ///< 自動縮放關鍵點間隔 (秒)
+    double zoomSmoothing = 1.0;     ///< 自動縮放平滑時間常數 (秒，0 表示不平滑)
+    double minRoiHeight = 0.0;      ///< 自動縮放 ROI 最小高度 (0 表示不限制)
+    double maxRoiHeight = 0.0;      ///< 自動縮放 ROI 最大高度 (0 表示影格高)
+};
+
+/**
+ * @brief CameraPath
+ * 每張影格一個裁切區域的預先計算結果
+ *
+ * 以結構陣列 (SoA) 儲存，預覽與輸出只需依影格編號取值，不再逐幀計算。
+ */
+class CameraPath {
+public:
+    bool isEmpty() const { return m_x.isEmpty(); }
+    int frameCount() const { return m_x.size(); }
+    double fps() const { return m_fps; }
+
+    /**
+     * @brief 第 index 張影格的裁切區域 (超出範圍時取端點)；路徑為空時回傳空矩形
+     */
+    QRectF roiAt(int index) const {
+        if (m_x.isEmpty()) return QRectF();
+        const int i = qBound(0, index, int(m_x.size()) - 1);
+        return QRectF(m_x[i], m_y[i], m_w[i], m_h[i]);
+    }
+
+    /**
+     * @brief 指定時間 (秒) 所在影格的裁切區域
+     */
+    QRectF roiAtTime(double sec) const { return roiAt(qRound(sec * m_fps)); }
+
+    /**
+     * @brief 整段路徑中最大的裁切區域大小 (輸出端依此預先配置裁切緩衝)
+     */
+    QSizeF maxRoiSize() const { return m_maxSize; }
+
+private:
+    friend class CameraPathPlanner;
+
+    double m_fps = 30.0;
+    QSizeF m_maxSize;
+    QVector<float> m_x, m_y;        ///< 左上角
+    QVector<float> m_w, m_h;        ///< 寬高
+};
+
+/**
+ * @brief CameraPathPlanner
+ * 將整段軌跡轉成逐幀裁切區域
+ *
+ * 三個階段各掃描一次：
+ * 1. 依影格時間重新取樣軌跡 (單一指標前進的線性內插，不做二分搜尋)
+ * 2. 套用死區、最大速度與加速度限制 (依序相依，逐幀一次)
+ * 3. 限制在影格內並轉成左上角座標 (無分支相依，可由編譯器向量化)
+ *
+ * 自動縮放時在 1 與 2 之間多一步：每 zoomKeyInterval 秒取人物框高度的中位數當關鍵點，
+ * 關鍵點做前後向指數平滑 (零相位，不會延遲)，再線性內插回每張影格的 ROI 寬高。
+ */
+class CameraPathPlanner {
+public:
+    /**
+     * @brief 規劃鏡頭路徑
+     * @param points 依時間遞增的軌跡
+     * @param params 規劃參數
+     * @param frameCount 影格數
+     * @return 逐幀裁切區域；軌跡為空或參數無效時回傳空路徑
+     */
+    static CameraPath plan(const QVector<DataPoint> &points, const CameraPathParams &params, int frameCount);
+};
+
+#endif // CAMERAPATHPLANNER_H
@@ -0,0 +1,101 @@
+#include "CropScript.h"
+#include <QDataStream>
+#include <QFileDevice>
+#include <QFileInfo>
+#include <QtMath>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief 第 i 張影格實際使用的整數裁切區域 (與輸出端 cropView 相同的取整)
+ */
+QRect integerRoi(const CameraPath &path, int i)
+{
+    const QRectF roi = path.roiAt(i);
+    return QRect(qFloor(roi.x()), qFloor(roi.y()), qRound(roi.width()), qRound(roi.height()));
+}
+
+} // namespace
+
+// -------------------------
+// ffmpeg sendcmd 腳本
+// -------------------------
+bool CropScript::writeSendCmd(QIODevice *device, const CameraPath &path, const QSize &frameSize,
+                              const QSize &outputSize, const QString &videoName)
+{
+    if (!device || !device->isWritable() || path.isEmpty() || frameSize.isEmpty()) return false;
+
+    // crop 濾鏡不能補黑邊：裁切區域先與影格求交集，補邊交給後面的 pad
+    const QRect frameRect(QPoint(0, 0), frameSize);
+    const QRect first = integerRoi(path, 0).intersected(frameRect);
+    const int outW = outputSize.isEmpty() ? frameSize.width() : outputSize.width();
+    const int outH = outputSize.isEmpty() ? frameSize.height() : outputSize.height();
+
+    // 寫到檔案時指令範例直接帶入腳本檔名
+    const QFileDevice *file = qobject_cast<const QFileDevice *>(device);
+    const QByteArray scriptName = file ? QFileInfo(file->fileName()).fileName().toUtf8() : QByteArray("crop.cmd");
+
+    QByteArray out;
+    out.reserve(64 + path.frameCount() * 24);
+    out += "# Auto-crop path: " + QByteArray::number(path.frameCount()) + " frames @ "
+           + QByteArray::number(path.fps(), 'g', 10) + " fps, source "
+           + QByteArray::number(frameSize.width()) + "x" + QByteArray::number(frameSize.height()) + "\n";
+    out += "# ffmpeg -i \"" + videoName.toUtf8() + "\" -filter_complex \"[0:v]sendcmd=f=" + scriptName + ","
+           + "crop@roi=" + QByteArray::number(first.width()) + ":" + QByteArray::number(first.height()) + ":"
+           + QByteArray::number(first.x()) + ":" + QByteArray::number(first.y()) + ":exact=1,"
+           + "scale=" + QByteArray::number(outW) + ":" + QByteArray::number(outH)
+           + ":force_original_aspect_ratio=decrease,"
+           + "pad=" + QByteArray::number(outW) + ":" + QByteArray::number(outH) + ":(ow-iw)/2:(oh-ih)/2[v]\""
+           + " -map \"[v]\" -map 0:a? -c:a copy output.mp4\n";
+
+    // 指令時間取前後兩張影格的中點，避免時間戳的浮點誤差錯過影格
+    QRect previous = first;
+    for (int i = 1; i < path.frameCount(); ++i) {
+        const QRect roi = integerRoi(path, i).intersected(frameRect);
+        if (roi == previous) continue;
+
+        out += QByteArray::number((i - 0.5) / path.fps(), 'f', 6);
+        const char *separator = " ";
+        auto command = [&](const char *name, int value) {
+            out += separator;
+            out += "crop@roi ";
+            out += name;
+            out += ' ';
+            out += QByteArray::number(value);
+            separator = ", ";
+        };
+        if (roi.width() != previous.width()) command("w", roi.width());
+        if (roi.height() != previous.height()) command("h", roi.height());
+        if (roi.x() != previous.x()) command("x", roi.x());
+        if (roi.y() != previous.y()) command("y", roi.y());
+        out += ";\n";
+        previous = roi;
+    }
+    return device->write(out) == out.size();
+}
+
+// -------------------------
+// 二進位裁切清單
+// -------------------------
+bool CropScript::writeBinary(QIODevice *device, const CameraPath &path, const QSize &frameSize)
+{
+    if (!device || !device->isWritable() || path.isEmpty()) return false;
+
+    QDataStream out(device);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    out << kMagic << kVersion << path.fps() << quint32(path.frameCount())
+        << quint16(frameSize.width()) << quint16(frameSize.height());
+
+    constexpr int lo = std::numeric_limits<qint16>::min(), hi = std::numeric_limits<qint16>::max();
+    for (int i = 0; i < path.frameCount(); ++i) {
+        const QRect roi = integerRoi(path, i);
+        if (roi.x() < lo || roi.x() > hi || roi.y() < lo || roi.y() > hi
+            || roi.width() < 0 || roi.width() > 0xFFFF || roi.height() < 0 || roi.height() > 0xFFFF) {
+            return false;
+        }
+        out << qint16(roi.x()) << qint16(roi.y()) << quint16(roi.width()) << quint16(roi.height());
+    }
+    return out.status() == QDataStream::Ok;
+}
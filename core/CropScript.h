@@ -0,0 +1,53 @@
+#ifndef CROPSCRIPT_H
+#define CROPSCRIPT_H
+
+#include <QIODevice>
+#include <QSize>
+#include <QString>
+#include "CameraPathPlanner.h"
+
+/**
+ * @brief CropScript
+ * 把逐幀裁切區域輸出成外部工具可用的附檔，不需要本程式解碼或編碼影片
+ *
+ * 兩種格式的裁切座標都與內建輸出相同 (左上角取 floor，寬高取 round)：
+ *
+ * 1. ffmpeg sendcmd 腳本 (.cmd)：
+ *    每張影格一行「時間 crop x X, crop y Y[, crop w W, crop h H];」，只寫出有變動的值。
+ *    檔頭註解附上對應的 ffmpeg 指令，crop 後接 scale + pad，裁切大小變動 (自動縮放) 或
+ *    超出影格時輸出尺寸不變。
+ *
+ * 2. 二進位裁切清單 (.tlcrop)，全部小端序，可依影格編號直接定位：
+ *    | 偏移 | 型別     | 內容                       |
+ *    | 0    | uint32   | magic 'TLCR' (0x52434C54)  |
+ *    | 4    | uint32   | 版本 (1)                   |
+ *    | 8    | float64  | 影格率                     |
+ *    | 16   | uint32   | 影格數 N                   |
+ *    | 20   | uint16×2 | 原始影格寬、高             |
+ *    | 24   | N × 8    | 每幀 int16 x, y, uint16 w, h (原始影片座標，x / y 可為負，表示補黑邊) |
+ */
+class CropScript {
+public:
+    static constexpr quint32 kMagic   = 0x52434C54; ///< 'TLCR'
+    static constexpr quint32 kVersion = 1;
+
+    /**
+     * @brief 寫出 ffmpeg sendcmd 腳本
+     * @param device 輸出裝置 (已開啟，文字模式)
+     * @param path 逐幀裁切區域
+     * @param frameSize 原始影格尺寸 (裁切限制在影格內)
+     * @param outputSize 輸出尺寸 (寫入檔頭的指令範例)
+     * @param videoName 原始影片檔名 (寫入檔頭的指令範例)
+     * @return 是否寫入成功
+     */
+    static bool writeSendCmd(QIODevice *device, const CameraPath &path, const QSize &frameSize,
+                             const QSize &outputSize, const QString &videoName);
+
+    /**
+     * @brief 寫出二進位裁切清單
+     * @return 是否寫入成功 (座標超出 int16 範圍時失敗)
+     */
+    static bool writeBinary(QIODevice *device, const CameraPath &path, const QSize &frameSize);
+};
+
+#endif // CROPSCRIPT_H
@@ -0,0 +1,35 @@
+#include "ExportSegments.h"
+
+// -------------------------
+// 切分片段 (對齊關鍵幀)
+// -------------------------
+QVector<ExportSegment> splitExportSegments(const QVector<qint64> &keyframes, double fps,
+                                           int firstFrame, int endFrame)
+{
+    QVector<ExportSegment> result;
+    if (endFrame <= firstFrame || fps <= 0) return result;
+
+    const int minFrames = qMax(1, qRound(kMinSegmentSec * fps));
+
+    // 候選切點：關鍵幀；沒有索引時固定間隔
+    QVector<int> cuts;
+    if (keyframes.isEmpty()) {
+        for (int f = firstFrame + minFrames; f < endFrame; f += minFrames) cuts.append(f);
+    } else {
+        for (qint64 ms : keyframes) {
+            const int f = qRound(ms / 1000.0 * fps);
+            if (f > firstFrame && f < endFrame) cuts.append(f);
+        }
+    }
+
+    // 太短的片段併入下一段；最後一段太短時併入前一段
+    int start = firstFrame;
+    for (int cut : cuts) {
+        if (cut - start < minFrames) continue;
+        result.append({ start, cut - start });
+        start = cut;
+    }
+    if (!result.isEmpty() && endFrame - start < minFrames) result.last().count = endFrame - result.last().first;
+    else result.append({ start, endFrame - start });
+    return result;
+}
@@ -0,0 +1,30 @@
+#ifndef EXPORTSEGMENTS_H
+#define EXPORTSEGMENTS_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief ExportSegment
+ * 輸出的一個片段 (原始影片影格範圍)
+ */
+struct ExportSegment {
+    int first = 0;          ///< 第一張影格
+    int count = 0;          ///< 影格數
+};
+
+constexpr double kMinSegmentSec = 2.0;  ///< 片段最短長度 (秒)；太短時串接與鍵值成本大於重新輸出
+
+/**
+ * @brief 依關鍵幀把輸出範圍切成片段 (增量輸出的快取單位)
+ * 片段起點對齊關鍵幀，每段至少 kMinSegmentSec 秒：太短的片段併入下一段，最後一段太短時併入前一段
+ * @param keyframes 關鍵幀時間 (毫秒，遞增)；為空時每 kMinSegmentSec 秒一段
+ * @param fps 影格率
+ * @param firstFrame 第一張影格
+ * @param endFrame 結尾影格 (不含)
+ * @return 依序相連、涵蓋 [firstFrame, endFrame) 的片段；範圍為空時為空
+ */
+QVector<ExportSegment> splitExportSegments(const QVector<qint64> &keyframes, double fps,
+                                           int firstFrame, int endFrame);
+
+#endif // EXPORTSEGMENTS_H
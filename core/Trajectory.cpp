@@ -0,0 +1,130 @@
+#include "Trajectory.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+constexpr quint32 kTrajectoryFields = 5;    ///< 專案檔軌跡每筆欄位數：time, x, y, w, h
+constexpr quint32 kTrajectoryMinFields = 3; ///< 舊版專案檔只有 time, x, y
+}
+
+// 專案檔以小端序儲存，軌跡段落直接以本機 double 陣列讀寫 (x86 / ARM)
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "project trajectory section assumes little-endian host");
+
+// -------------------------
+// CSV 解析
+// -------------------------
+QVector<DataPoint> parseTrajectoryCsv(QIODevice *device)
+{
+    QVector<DataPoint> points;
+    if (!device) return points;
+
+    // 逐行讀取位元組，只切出前五欄，不建立整列的 QStringList
+    while (!device->atEnd()) {
+        const QByteArray line = device->readLine();
+
+        double values[5] = { 0, 0, 0, 0, 0 };
+        int field = 0;
+        qsizetype begin = 0;
+        while (field < 5 && begin <= line.size()) {
+            qsizetype end = line.indexOf(',', begin);
+            if (end < 0) end = line.size();
+            bool ok = false;
+            const double v = QByteArrayView(line).sliced(begin, end - begin).trimmed().toDouble(&ok);
+            if (!ok) break;
+            values[field++] = v;
+            begin = end + 1;
+        }
+
+        if (field >= 3) points.append({ values[0], values[1], values[2], values[3], values[4] });
+    }
+    return points;
+}
+
+// -------------------------
+// 取樣軌跡 (線性內插)
+// -------------------------
+QPointF sampleTrajectory(const QVector<DataPoint> &points, double sec)
+{
+    auto it = std::lower_bound(
+        points.begin(), points.end(), sec,
+        [](const DataPoint &d, double t) { return d.time < t; });
+
+    if (it == points.end()) return QPointF(points.back().x, points.back().y);
+    if (it == points.begin() || it->time <= sec) return QPointF(it->x, it->y);
+
+    const DataPoint &a = *(it - 1);
+    const DataPoint &b = *it;
+    double t = (sec - a.time) / (b.time - a.time);
+    return QPointF(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t);
+}
+
+// -------------------------
+// 以新區段取代軌跡
+// -------------------------
+QVector<DataPoint> spliceTrajectory(const QVector<DataPoint> &points, const QVector<DataPoint> &span,
+                                    double tolerance)
+{
+    if (span.isEmpty()) return points;
+
+    auto byTime = [](const DataPoint &d, double t) { return d.time < t; };
+    const auto begin = std::lower_bound(points.begin(), points.end(), span.first().time - tolerance, byTime);
+    const auto end = std::upper_bound(begin, points.end(), span.last().time + tolerance,
+                                      [](double t, const DataPoint &d) { return t < d.time; });
+
+    QVector<DataPoint> result;
+    result.reserve(points.size() - (end - begin) + span.size());
+    std::copy(points.begin(), begin, std::back_inserter(result));
+    result.append(span);
+    std::copy(end, points.end(), std::back_inserter(result));
+    return result;
+}
+
+// -------------------------
+// 專案檔軌跡段落
+// -------------------------
+QByteArray encodeTrajectory(const QVector<DataPoint> &points)
+{
+    const quint32 header[2] = { quint32(points.size()), kTrajectoryFields };
+    QByteArray data;
+    data.reserve(sizeof(header) + points.size() * kTrajectoryFields * sizeof(double));
+    data.append(reinterpret_cast<const char *>(header), sizeof(header));
+    for (const DataPoint &d : points) {
+        const double v[kTrajectoryFields] = { d.time, d.x, d.y, d.w, d.h };
+        data.append(reinterpret_cast<const char *>(v), sizeof(v));
+    }
+    return data;
+}
+
+QVector<DataPoint> decodeTrajectory(const QByteArray &data)
+{
+    QVector<DataPoint> points;
+    quint32 header[2] = { 0, 0 };
+    if (data.size() < qsizetype(sizeof(header))) return points;
+    std::memcpy(header, data.constData(), sizeof(header));
+
+    const quint32 count = header[0], fields = header[1];
+    if (fields < kTrajectoryMinFields
+        || data.size() < qsizetype(sizeof(header) + qint64(count) * fields * sizeof(double))) {
+        return points;
+    }
+
+    // 段落起點 8 位元組對齊，映射記憶體可直接當 double 陣列
+    const double *v = reinterpret_cast<const double *>(data.constData() + sizeof(header));
+    points.resize(count);
+    for (quint32 i = 0; i < count; ++i, v += fields) {
+        points[i] = { v[0], v[1], v[2], fields >= 5 ? v[3] : 0.0, fields >= 5 ? v[4] : 0.0 };
+    }
+    return points;
+}
+
+// -------------------------
+// 裁切區域與影格求交集
+// -------------------------
+CropClip clipCropRect(const QRect &roi, const QSize &frame)
+{
+    CropClip clip;
+    clip.source = roi.intersected(QRect(QPoint(0, 0), frame));
+    clip.dest = clip.source.isEmpty() ? QPoint() : clip.source.topLeft() - roi.topLeft();
+    return clip;
+}
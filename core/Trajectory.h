@@ -0,0 +1,83 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+// -----------------------------
+// 基礎數據結構
+// -----------------------------
+/**
+ * @brief DataPoint
+ * 單個數據點，包含時間、位置與人物框大小
+ */
+struct DataPoint {
+    double time;    ///< 時間 (秒)
+    double x;       ///< x 座標
+    double y;       ///< y 座標
+    double w = 0;   ///< 人物框寬 (未知時為 0)
+    double h = 0;   ///< 人物框高 (未知時為 0)
+};
+
+/**
+ * @brief 解析追蹤 CSV (time_sec, x, y, w, h, ...)
+ * 前三欄必填，w / h 可省略；標題列或非數字列略過
+ * @param device 已開啟的 CSV
+ * @return 依檔案順序的數據點
+ */
+QVector<DataPoint> parseTrajectoryCsv(QIODevice *device);
+
+/**
+ * @brief 取樣軌跡：在前後兩個數據點之間線性內插
+ * @param points 依時間遞增的數據點 (不可為空)
+ * @param sec 影片時間 (秒)
+ * @return 該時間的人物座標；超出範圍時取端點
+ */
+QPointF sampleTrajectory(const QVector<DataPoint> &points, double sec);
+
+/**
+ * @brief 以新的區段取代軌跡中同一時間範圍的數據點
+ * @param points 依時間遞增的數據點
+ * @param span 新的區段 (依時間遞增，可為空)
+ * @param tolerance 時間容差 (秒)：區段首尾各往外延伸此範圍內的舊數據點一併移除 (通常為半格)
+ * @return 合併後依時間遞增的數據點
+ */
+QVector<DataPoint> spliceTrajectory(const QVector<DataPoint> &points, const QVector<DataPoint> &span,
+                                    double tolerance);
+
+/**
+ * @brief 軌跡 → 專案檔段落：[筆數, 欄位數] (quint32) 後接每筆 time, x, y, w, h 的 double 陣列
+ */
+QByteArray encodeTrajectory(const QVector<DataPoint> &points);
+
+/**
+ * @brief 專案檔段落 → 軌跡
+ * 舊版 (三欄：time, x, y) 的人物框大小為 0，欄位數較多 (新版) 時只取前五欄
+ * @param data 段落資料 (起點須 8 位元組對齊，可直接指向映射記憶體)
+ * @return 數據點；格式不符或資料不足時為空
+ */
+QVector<DataPoint> decodeTrajectory(const QByteArray &data);
+
+/**
+ * @brief CropClip
+ * 裁切矩形與影格的交集：source 為影格中實際可取的區域，
+ * dest 為其在裁切輸出 (補黑邊) 中的左上角
+ */
+struct CropClip {
+    QRect source;   ///< 影格中的來源區域，完全在影格外時為空
+    QPoint dest;    ///< 在裁切輸出中的位置
+};
+
+/**
+ * @brief 將以原始影片座標表示的裁切區域限制在影格內
+ * @param roi 裁切區域 (可超出影格)
+ * @param frame 影格尺寸
+ */
+CropClip clipCropRect(const QRect &roi, const QSize &frame);
+
+#endif // TRAJECTORY_H
@@ -0,0 +1,13 @@
+# 連結 core 靜態程式庫 (需由上層 subdirs 專案先建置 core)
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lcore
+
+win32-g++: PRE_TARGETDEPS += $$CORE_LIB_DIR/libcore.a
+else:win32: PRE_TARGETDEPS += $$CORE_LIB_DIR/core.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libcore.a
@@ -0,0 +1,17 @@
+# 不依賴 Widgets 的核心程式庫：軌跡解析、取樣、鏡頭路徑規劃、裁切腳本輸出與輸出片段切分
+# 主程式、基準測試與之後的命令列工具共用
+TEMPLATE = lib
+CONFIG += staticlib c++17
+QT = core
+
+TARGET = core
+
+SOURCES += CameraPathPlanner.cpp \
+           CropScript.cpp \
+           ExportSegments.cpp \
+           Trajectory.cpp
+
+HEADERS += CameraPathPlanner.h \
+           CropScript.h \
+           ExportSegments.h \
+           Trajectory.h
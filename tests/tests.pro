@@ -0,0 +1,11 @@
+QT += core testlib
+QT -= gui
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_core
+
+# 核心程式庫的單元測試 (make check 執行)
+SOURCES += tst_core.cpp
+
+include(../core/core.pri)
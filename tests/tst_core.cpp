@@ -0,0 +1,605 @@
+#include <QtTest>
+#include "CameraPathPlanner.h"
+#include "CropScript.h"
+#include "ExportSegments.h"
+
+/**
+ * @brief TestCore
+ * 核心程式庫的單元測試 (鏡頭路徑規劃、自動縮放、專案檔軌跡段落、軌跡區段取代、輸出片段切分、裁切附檔)
+ *
+ * 預設參數：30 fps、100×100 裁切區域、1000×1000 影格，
+ * 人物只在 x 方向移動，檢查裁切區域中心的逐幀變化；
+ * 自動縮放以每格一筆的人物框高度檢查逐幀 ROI 高度。
+ */
+class TestCore : public QObject {
+    Q_OBJECT
+
+private slots:
+    void planEmpty();
+    void planDeadZone();
+    void planMaxVelocity();
+    void planMaxAcceleration();
+    void planBraking();
+    void planClampToFrame();
+    void planRoiLargerThanFrame();
+
+    void zoomMedianKeyframes();
+    void zoomSmoothingSymmetric();
+    void zoomClamp_data();
+    void zoomClamp();
+    void zoomWithoutBoxes();
+
+    void decodeLegacyTrajectory();
+    void decodeTrajectoryRoundTrip();
+
+    void spliceStart();
+    void spliceMiddle();
+    void spliceEnd();
+    void spliceEmpty();
+    void spliceConverged();
+    void spliceTolerance();
+
+    void segmentsFixedInterval();
+    void segmentsKeyframeAligned();
+    void segmentsShortTail();
+    void segmentsEmpty();
+
+    void cropSendCmdChangesOnly();
+    void cropBinaryHeader();
+    void cropBinaryRoundTrip();
+    void cropBinaryOutOfRange();
+
+private:
+    static CameraPathParams params();
+    static CameraPathParams zoomParams();
+    static QVector<DataPoint> step(double from, double to);
+    static QVector<DataPoint> boxes(const QVector<double> &heights);
+    static QVector<DataPoint> track(int count, double x);
+    static CameraPath cropPath();
+    static void verifySorted(const QVector<DataPoint> &points);
+    static void verifySegments(const QVector<ExportSegment> &segments, int first, int end);
+    static double centerX(const CameraPath &path, int frame) { return path.roiAt(frame).center().x(); }
+};
+
+namespace {
+constexpr double kFps = 30.0;
+constexpr double kEpsilon = 1e-2;   ///< 裁切區域以 float 儲存
+}
+
+CameraPathParams TestCore::params()
+{
+    CameraPathParams p;
+    p.roiSize = QSizeF(100, 100);
+    p.frameSize = QSize(1000, 1000);
+    p.fps = kFps;
+    return p;
+}
+
+/**
+ * @brief 自動縮放：關鍵點每 15 格、不平滑、人物框佔滿 ROI 高度
+ */
+CameraPathParams TestCore::zoomParams()
+{
+    CameraPathParams p = params();
+    p.autoZoom = true;
+    p.zoomKeyInterval = 0.5;
+    p.zoomSmoothing = 0;
+    p.subjectFill = 1.0;
+    return p;
+}
+
+/**
+ * @brief 人物在第 0 與第 1 張影格之間從 from 跳到 to，之後停住
+ */
+QVector<DataPoint> TestCore::step(double from, double to)
+{
+    return { { 0.0, from, 500 }, { 0.5 / kFps, to, 500 } };
+}
+
+// -------------------------
+// 鏡頭路徑規劃
+// -------------------------
+void TestCore::planEmpty()
+{
+    QVERIFY(CameraPathPlanner::plan({}, params(), 10).isEmpty());
+    QVERIFY(CameraPathPlanner::plan(step(500, 500), params(), 0).isEmpty());
+
+    CameraPathParams p = params();
+    p.roiSize = QSizeF();
+    QVERIFY(CameraPathPlanner::plan(step(500, 500), p, 10).isEmpty());
+}
+
+void TestCore::planDeadZone()
+{
+    CameraPathParams p = params();
+    p.deadZone = 0.25;  // ROI 寬 100 → 偏離 25 像素以內不動
+
+    // 死區內：鏡頭完全不動
+    const QVector<DataPoint> inside = { { 0.0, 500, 500 }, { 1.0, 520, 500 } };
+    const CameraPath still = CameraPathPlanner::plan(inside, p, 31);
+    QCOMPARE(still.frameCount(), 31);
+    for (int i = 0; i < still.frameCount(); ++i) QCOMPARE(centerX(still, i), 500.0);
+
+    // 死區外：只跟到死區邊緣
+    const CameraPath moved = CameraPathPlanner::plan(step(500, 600), p, 10);
+    for (int i = 1; i < moved.frameCount(); ++i) QVERIFY(qAbs(centerX(moved, i) - 575.0) < kEpsilon);
+
+    // 沒有死區時永遠置中
+    p.deadZone = 0;
+    const CameraPath centered = CameraPathPlanner::plan(step(500, 600), p, 10);
+    for (int i = 1; i < centered.frameCount(); ++i) QVERIFY(qAbs(centerX(centered, i) - 600.0) < kEpsilon);
+}
+
+void TestCore::planMaxVelocity()
+{
+    CameraPathParams p = params();
+    p.maxVelocity = 60;     // 每格最多 2 像素
+
+    const CameraPath path = CameraPathPlanner::plan(step(500, 900), p, 61);
+    QCOMPARE(centerX(path, 0), 500.0);
+    for (int i = 1; i < path.frameCount(); ++i) {
+        QVERIFY2(centerX(path, i) - centerX(path, i - 1) <= p.maxVelocity / kFps + kEpsilon,
+                 qPrintable(QString("frame %1").arg(i)));
+    }
+    // 目標很遠：全程以最大速度前進
+    QVERIFY(qAbs(centerX(path, 30) - 560.0) < kEpsilon);
+    QVERIFY(qAbs(centerX(path, 60) - 620.0) < kEpsilon);
+}
+
+void TestCore::planMaxAcceleration()
+{
+    CameraPathParams p = params();
+    p.maxAcceleration = 300;    // 每格速度最多變化 10 像素/秒
+
+    const CameraPath path = CameraPathPlanner::plan(step(500, 900), p, 121);
+    double previous = 0;
+    for (int i = 1; i < path.frameCount(); ++i) {
+        const double velocity = (centerX(path, i) - centerX(path, i - 1)) * kFps;
+        QVERIFY2(qAbs(velocity - previous) <= p.maxAcceleration / kFps + 0.1,
+                 qPrintable(QString("frame %1: %2 → %3").arg(i).arg(previous).arg(velocity)));
+        previous = velocity;
+    }
+    // 起步是等加速度：第 n 格位移 = a·dt²·n(n+1)/2
+    QVERIFY(qAbs(centerX(path, 3) - (500.0 + 300.0 / (kFps * kFps) * 6)) < kEpsilon);
+}
+
+void TestCore::planBraking()
+{
+    CameraPathParams p = params();
+    p.maxAcceleration = 300;
+
+    // 沒有煞車距離限制時約會衝過頭 v²/2a ≈ 100 像素；有限制時只剩離散化誤差
+    const CameraPath path = CameraPathPlanner::plan(step(500, 600), p, 181);
+    double peak = 0, furthest = 0;
+    for (int i = 1; i < path.frameCount(); ++i) {
+        peak = qMax(peak, (centerX(path, i) - centerX(path, i - 1)) * kFps);
+        furthest = qMax(furthest, centerX(path, i));
+    }
+    QVERIFY2(furthest - 600.0 < 5.0, qPrintable(QString("overshoot %1").arg(furthest - 600.0)));
+
+    // 到達前已減速，最後停在目標上
+    const double arrival = (centerX(path, 30) - centerX(path, 29)) * kFps;
+    QVERIFY(arrival < peak / 2);
+    QVERIFY(qAbs(centerX(path, 180) - 600.0) < kEpsilon);
+}
+
+void TestCore::planClampToFrame()
+{
+    CameraPathParams p = params();
+
+    // 人物貼近左緣 / 右緣：裁切區域停在影格內
+    QCOMPARE(CameraPathPlanner::plan(step(20, 20), p, 2).roiAt(1).left(), 0.0);
+    QCOMPARE(CameraPathPlanner::plan(step(990, 990), p, 2).roiAt(1).right(), 1000.0);
+
+    // 不限制時照人物置中
+    p.clampToFrame = false;
+    QCOMPARE(CameraPathPlanner::plan(step(20, 20), p, 2).roiAt(1).left(), -30.0);
+}
+
+void TestCore::planRoiLargerThanFrame()
+{
+    CameraPathParams p = params();
+    p.roiSize = QSizeF(200, 200);
+    p.frameSize = QSize(100, 100);
+
+    // ROI 比影格大：固定置中，兩側補黑邊
+    const CameraPath path = CameraPathPlanner::plan(step(0, 100), p, 5);
+    for (int i = 0; i < path.frameCount(); ++i) QCOMPARE(path.roiAt(i), QRectF(-50, -50, 200, 200));
+}
+
+/**
+ * @brief 每張影格一筆數據點，人物框高度依序為 heights
+ * 時間與規劃器的影格時間 (i · dt) 完全相同，取樣時不內插
+ */
+QVector<DataPoint> TestCore::boxes(const QVector<double> &heights)
+{
+    QVector<DataPoint> points;
+    for (int i = 0; i < heights.size(); ++i) points.append({ i * (1.0 / kFps), 500, 500, heights[i], heights[i] });
+    return points;
+}
+
+// -------------------------
+// 自動縮放
+// -------------------------
+void TestCore::zoomMedianKeyframes()
+{
+    // 第 15 格 (關鍵點 1 的中心) 偵測框單幀暴增：中位數不受影響，平均值會變成 160
+    QVector<double> heights(61, 100.0);
+    heights[15] = 1000;
+    CameraPathParams p = zoomParams();
+    p.subjectFill = 0.5;
+
+    const CameraPath path = CameraPathPlanner::plan(boxes(heights), p, heights.size());
+    QCOMPARE(path.frameCount(), heights.size());
+    for (int i = 0; i < path.frameCount(); ++i) {
+        QCOMPARE(path.roiAt(i).height(), 200.0);
+        QCOMPARE(path.roiAt(i).width(), 200.0);     // 維持 roiSize 的長寬比
+    }
+    QCOMPARE(path.maxRoiSize(), QSizeF(200, 200));
+
+    // 持續的變化 (佔窗口多數) 則會反映在關鍵點上
+    heights.fill(100.0);
+    for (int i = 23; i < heights.size(); ++i) heights[i] = 200;
+    const CameraPath grown = CameraPathPlanner::plan(boxes(heights), p, heights.size());
+    QCOMPARE(grown.roiAt(15).height(), 200.0);
+    QCOMPARE(grown.roiAt(30).height(), 400.0);
+}
+
+void TestCore::zoomSmoothingSymmetric()
+{
+    // 第 150 格 (關鍵點 10) 附近的短暫放大：前後向平滑後左右對稱，峰值不延遲
+    QVector<double> heights(301, 100.0);
+    for (int i = 143; i <= 157; ++i) heights[i] = 300;
+    CameraPathParams p = zoomParams();
+    p.zoomSmoothing = 1.0;
+
+    const CameraPath path = CameraPathPlanner::plan(boxes(heights), p, heights.size());
+    const double peak = path.roiAt(150).height();
+    QVERIFY2(peak > 100 && peak < 300, qPrintable(QString("peak %1").arg(peak)));
+    for (int d = 1; d <= 150; ++d) {
+        const double before = path.roiAt(150 - d).height();
+        const double after = path.roiAt(150 + d).height();
+        QVERIFY(before <= peak && after <= peak);
+        // 有限長度的邊界效應只留下極小的差異 (< 振幅的 0.5%)
+        QVERIFY2(qAbs(before - after) < 1.0, qPrintable(QString("±%1: %2 vs %3").arg(d).arg(before).arg(after)));
+    }
+}
+
+void TestCore::zoomClamp_data()
+{
+    QTest::addColumn<double>("box");
+    QTest::addColumn<double>("minRoiHeight");
+    QTest::addColumn<double>("maxRoiHeight");
+    QTest::addColumn<double>("expected");
+
+    QTest::newRow("inside") << 500.0 << 240.0 << 0.0 << 500.0;
+    QTest::newRow("below minRoiHeight") << 10.0 << 240.0 << 0.0 << 240.0;
+    QTest::newRow("above frame height") << 2000.0 << 240.0 << 0.0 << 1000.0;
+    QTest::newRow("above maxRoiHeight") << 800.0 << 240.0 << 600.0 << 600.0;
+    QTest::newRow("minRoiHeight wins over frame") << 10.0 << 1200.0 << 0.0 << 1200.0;
+}
+
+void TestCore::zoomClamp()
+{
+    QFETCH(double, box);
+    QFETCH(double, minRoiHeight);
+    QFETCH(double, maxRoiHeight);
+    QFETCH(double, expected);
+
+    CameraPathParams p = zoomParams();
+    p.minRoiHeight = minRoiHeight;
+    p.maxRoiHeight = maxRoiHeight;
+
+    const CameraPath path = CameraPathPlanner::plan(boxes(QVector<double>(31, box)), p, 31);
+    for (int i = 0; i < path.frameCount(); ++i) QCOMPARE(path.roiAt(i).height(), expected);
+}
+
+void TestCore::zoomWithoutBoxes()
+{
+    // 舊軌跡沒有人物框：維持固定的 roiSize
+    const CameraPath path = CameraPathPlanner::plan(boxes(QVector<double>(31, 0.0)), zoomParams(), 31);
+    QCOMPARE(path.frameCount(), 31);
+    for (int i = 0; i < path.frameCount(); ++i) QCOMPARE(path.roiAt(i).size(), QSizeF(100, 100));
+}
+
+// -------------------------
+// 專案檔軌跡段落
+// -------------------------
+void TestCore::decodeLegacyTrajectory()
+{
+    // 舊版段落：[筆數, 3] 後接 time, x, y
+    const quint32 header[2] = { 2, 3 };
+    const double values[6] = { 0.0, 500, 400, 1.0, 600, 450 };
+    QByteArray data(reinterpret_cast<const char *>(header), sizeof(header));
+    data.append(reinterpret_cast<const char *>(values), sizeof(values));
+
+    const QVector<DataPoint> points = decodeTrajectory(data);
+    QCOMPARE(points.size(), 2);
+    QCOMPARE(points[1].time, 1.0);
+    QCOMPARE(points[1].x, 600.0);
+    QCOMPARE(points[1].y, 450.0);
+    QCOMPARE(points[1].w, 0.0);
+    QCOMPARE(points[1].h, 0.0);
+
+    // 自動縮放時沒有人物框資料，鏡頭仍照常跟隨
+    const CameraPath path = CameraPathPlanner::plan(points, zoomParams(), 31);
+    QCOMPARE(path.roiAt(30), QRectF(550, 400, 100, 100));
+
+    // 資料不足時不讀越界
+    data.chop(sizeof(double));
+    QVERIFY(decodeTrajectory(data).isEmpty());
+}
+
+void TestCore::decodeTrajectoryRoundTrip()
+{
+    const QVector<DataPoint> points = { { 0.0, 1, 2, 3, 4 }, { 0.5, 5, 6, 7, 8 } };
+    const QVector<DataPoint> decoded = decodeTrajectory(encodeTrajectory(points));
+    QCOMPARE(decoded.size(), points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        QCOMPARE(decoded[i].time, points[i].time);
+        QCOMPARE(decoded[i].x, points[i].x);
+        QCOMPARE(decoded[i].y, points[i].y);
+        QCOMPARE(decoded[i].w, points[i].w);
+        QCOMPARE(decoded[i].h, points[i].h);
+    }
+}
+
+// -------------------------
+// 軌跡區段取代
+// -------------------------
+/**
+ * @brief 每 0.1 秒一筆、x 固定的舊軌跡
+ */
+QVector<DataPoint> TestCore::track(int count, double x)
+{
+    QVector<DataPoint> points;
+    for (int i = 0; i < count; ++i) points.append({ i * 0.1, x, 0 });
+    return points;
+}
+
+void TestCore::verifySorted(const QVector<DataPoint> &points)
+{
+    for (int i = 1; i < points.size(); ++i)
+        QVERIFY2(points[i - 1].time < points[i].time, qPrintable(QString("index %1").arg(i)));
+}
+
+void TestCore::spliceStart()
+{
+    const QVector<DataPoint> result = spliceTrajectory(track(11, 0), track(3, 1), 0.05);
+    QCOMPARE(result.size(), 11);
+    verifySorted(result);
+    for (int i = 0; i < result.size(); ++i) QCOMPARE(result[i].x, i < 3 ? 1.0 : 0.0);
+}
+
+void TestCore::spliceMiddle()
+{
+    const QVector<DataPoint> span = { { 0.4, 1, 0 }, { 0.5, 1, 0 }, { 0.6, 1, 0 } };
+    const QVector<DataPoint> result = spliceTrajectory(track(11, 0), span, 0.05);
+    QCOMPARE(result.size(), 11);
+    verifySorted(result);
+    for (int i = 0; i < result.size(); ++i) QCOMPARE(result[i].x, (i >= 4 && i <= 6) ? 1.0 : 0.0);
+}
+
+void TestCore::spliceEnd()
+{
+    // 重新追蹤超出舊軌跡結尾：結尾之後的數據點附加在後
+    const QVector<DataPoint> span = { { 0.9, 1, 0 }, { 1.0, 1, 0 }, { 1.1, 1, 0 }, { 1.2, 1, 0 } };
+    const QVector<DataPoint> result = spliceTrajectory(track(11, 0), span, 0.05);
+    QCOMPARE(result.size(), 13);
+    verifySorted(result);
+    QCOMPARE(result[8].x, 0.0);
+    for (int i = 9; i < result.size(); ++i) QCOMPARE(result[i].x, 1.0);
+    QCOMPARE(result.last().time, 1.2);
+}
+
+void TestCore::spliceEmpty()
+{
+    const QVector<DataPoint> points = track(11, 0);
+
+    // 沒有新區段：原樣回傳
+    const QVector<DataPoint> unchanged = spliceTrajectory(points, {}, 0.05);
+    QCOMPARE(unchanged.size(), points.size());
+    for (int i = 0; i < points.size(); ++i) QCOMPARE(unchanged[i].time, points[i].time);
+
+    // 沒有舊軌跡 (尚未追蹤就校正)：結果就是新區段
+    const QVector<DataPoint> span = track(3, 1);
+    const QVector<DataPoint> fresh = spliceTrajectory({}, span, 0.05);
+    QCOMPARE(fresh.size(), span.size());
+    QCOMPARE(fresh.last().x, 1.0);
+}
+
+void TestCore::spliceConverged()
+{
+    // 區段最後幾筆已回到原軌跡 (x = 0)：收斂點之後的舊軌跡原樣保留，不重複也不留空缺
+    const QVector<DataPoint> span = { { 0.3, 1, 0 }, { 0.4, 1, 0 }, { 0.5, 0, 0 }, { 0.6, 0, 0 } };
+    const QVector<DataPoint> result = spliceTrajectory(track(11, 0), span, 0.05);
+    QCOMPARE(result.size(), 11);
+    verifySorted(result);
+    QCOMPARE(result[3].x, 1.0);
+    QCOMPARE(result[4].x, 1.0);
+    for (int i = 5; i < result.size(); ++i) {
+        QCOMPARE(result[i].x, 0.0);
+        QCOMPARE(result[i].time, i * 0.1);
+    }
+}
+
+void TestCore::spliceTolerance()
+{
+    // 新區段的時間與舊軌跡差了不到半格：容差內的舊數據點一併移除，不會出現時間幾乎相同的兩筆
+    const QVector<DataPoint> span = { { 0.41, 1, 0 }, { 0.51, 1, 0 } };
+    const QVector<DataPoint> result = spliceTrajectory(track(11, 0), span, 0.05);
+    QCOMPARE(result.size(), 11);
+    verifySorted(result);
+    QCOMPARE(result[3].time, 0.3);
+    QCOMPARE(result[4].time, 0.41);
+    QCOMPARE(result[5].time, 0.51);
+    QCOMPARE(result[6].time, 0.6);
+
+    // 容差為 0 時只移除區段範圍內的舊數據點
+    const QVector<DataPoint> strict = spliceTrajectory(track(11, 0), span, 0);
+    QCOMPARE(strict.size(), 12);
+    verifySorted(strict);
+}
+
+// -------------------------
+// 輸出片段切分
+// -------------------------
+/**
+ * @brief 片段依序相連、涵蓋 [first, end)，且除了整段不足最短長度外每段至少 kMinSegmentSec 秒
+ */
+void TestCore::verifySegments(const QVector<ExportSegment> &segments, int first, int end)
+{
+    QVERIFY(!segments.isEmpty());
+    QCOMPARE(segments.first().first, first);
+    QCOMPARE(segments.last().first + segments.last().count, end);
+    for (int i = 0; i < segments.size(); ++i) {
+        if (i > 0) QCOMPARE(segments[i].first, segments[i - 1].first + segments[i - 1].count);
+        if (segments.size() > 1) QVERIFY(segments[i].count >= qRound(kMinSegmentSec * kFps));
+    }
+}
+
+void TestCore::segmentsFixedInterval()
+{
+    // 沒有關鍵幀索引：每 2 秒 (60 格) 一段
+    const QVector<ExportSegment> segments = splitExportSegments({}, kFps, 0, 180);
+    verifySegments(segments, 0, 180);
+    QCOMPARE(segments.size(), 3);
+    QCOMPARE(segments[1].first, 60);
+    QCOMPARE(segments[2].first, 120);
+}
+
+void TestCore::segmentsKeyframeAligned()
+{
+    // 關鍵幀在第 30、75、90、150、270 格：起點只落在關鍵幀上，相距不足 60 格的關鍵幀略過
+    const QVector<qint64> keyframes = { 1000, 2500, 3000, 5000, 9000 };
+    const QVector<ExportSegment> segments = splitExportSegments(keyframes, kFps, 0, 300);
+    verifySegments(segments, 0, 300);
+    QCOMPARE(segments.size(), 3);
+    QCOMPARE(segments[1].first, 75);
+    QCOMPARE(segments[2].first, 150);
+
+    // 範圍外的關鍵幀不影響切點，第一段從入點開始 (入點不必是關鍵幀)
+    const QVector<qint64> around = { 3000, 6000, 6667, 13000 };
+    const QVector<ExportSegment> ranged = splitExportSegments(around, kFps, 100, 400);
+    verifySegments(ranged, 100, 400);
+    QCOMPARE(ranged.size(), 2);
+    QCOMPARE(ranged[1].first, 180);
+}
+
+void TestCore::segmentsShortTail()
+{
+    // 最後一段只剩 20 格：併入前一段，不產生過短的片段
+    const QVector<ExportSegment> segments = splitExportSegments({}, kFps, 0, 200);
+    verifySegments(segments, 0, 200);
+    QCOMPARE(segments.size(), 3);
+    QCOMPARE(segments.last().first, 120);
+    QCOMPARE(segments.last().count, 80);
+
+    // 整段都不足最短長度：只有一段
+    const QVector<ExportSegment> single = splitExportSegments({ 500 }, kFps, 10, 40);
+    QCOMPARE(single.size(), 1);
+    QCOMPARE(single[0].first, 10);
+    QCOMPARE(single[0].count, 30);
+}
+
+void TestCore::segmentsEmpty()
+{
+    QVERIFY(splitExportSegments({}, kFps, 100, 100).isEmpty());
+    QVERIFY(splitExportSegments({}, kFps, 100, 50).isEmpty());
+    QVERIFY(splitExportSegments({}, 0, 0, 100).isEmpty());
+}
+
+// -------------------------
+// 裁切附檔
+// -------------------------
+/**
+ * @brief 8 張影格：第 3 格起 x 從 500 移到 600，第 5 格起 y 從 500 移到 700
+ */
+CameraPath TestCore::cropPath()
+{
+    const QVector<DataPoint> points = { { 0.0, 500, 500 }, { 2 / kFps, 500, 500 }, { 2.5 / kFps, 600, 500 },
+                                        { 4 / kFps, 600, 500 }, { 4.5 / kFps, 600, 700 } };
+    return CameraPathPlanner::plan(points, params(), 8);
+}
+
+void TestCore::cropSendCmdChangesOnly()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QVERIFY(CropScript::writeSendCmd(&buffer, cropPath(), QSize(1000, 1000), QSize(1280, 720), "in.mp4"));
+
+    // 檔頭註解的指令範例帶入第一張影格的裁切區域
+    const QList<QByteArray> lines = buffer.data().split('\n');
+    QVERIFY(lines[1].startsWith("# ffmpeg -i \"in.mp4\""));
+    QVERIFY(lines[1].contains("crop@roi=100:100:450:450:exact=1"));
+
+    // 只有區域改變的影格才有指令，時間取前後影格的中點，只寫出變動的值
+    QList<QByteArray> commands;
+    for (const QByteArray &line : lines) {
+        if (!line.isEmpty() && !line.startsWith('#')) commands.append(line);
+    }
+    QCOMPARE(commands.size(), 2);
+    QCOMPARE(commands[0], QByteArray("0.083333 crop@roi x 550;"));
+    QCOMPARE(commands[1], QByteArray("0.150000 crop@roi y 650;"));
+}
+
+void TestCore::cropBinaryHeader()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(CropScript::writeBinary(&buffer, cropPath(), QSize(1000, 1000)));
+    QCOMPARE(buffer.size(), qint64(24 + 8 * 8));
+
+    // 'TLCR'、版本、影格率、影格數、原始影格尺寸，全部小端序
+    const QByteArray data = buffer.data();
+    QCOMPARE(data.left(4), QByteArray("TLCR"));
+    QDataStream in(data);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    quint32 magic = 0, version = 0, count = 0;
+    double fps = 0;
+    quint16 width = 0, height = 0;
+    in >> magic >> version >> fps >> count >> width >> height;
+    QCOMPARE(magic, CropScript::kMagic);
+    QCOMPARE(version, CropScript::kVersion);
+    QCOMPARE(fps, kFps);
+    QCOMPARE(count, quint32(8));
+    QCOMPARE(width, quint16(1000));
+    QCOMPARE(height, quint16(1000));
+}
+
+void TestCore::cropBinaryRoundTrip()
+{
+    // ROI 比影格大時置中，左上角為負 (補黑邊)
+    CameraPathParams p = params();
+    p.roiSize = QSizeF(200, 200);
+    p.frameSize = QSize(100, 100);
+    for (const CameraPath &path : { cropPath(), CameraPathPlanner::plan(step(0, 100), p, 5) }) {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QVERIFY(CropScript::writeBinary(&buffer, path, QSize(1000, 1000)));
+
+        QDataStream in(buffer.data().mid(24));
+        in.setByteOrder(QDataStream::LittleEndian);
+        for (int i = 0; i < path.frameCount(); ++i) {
+            qint16 x = 0, y = 0;
+            quint16 w = 0, h = 0;
+            in >> x >> y >> w >> h;
+            QCOMPARE(QRect(x, y, w, h), path.roiAt(i).toRect());
+        }
+        QVERIFY(in.atEnd());
+    }
+}
+
+void TestCore::cropBinaryOutOfRange()
+{
+    // 左上角超出 int16：拒絕寫出，不截斷
+    CameraPathParams p = params();
+    p.frameSize = QSize(60000, 1000);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(!CropScript::writeBinary(&buffer, CameraPathPlanner::plan(step(40000, 40000), p, 2), p.frameSize));
+}
+
+QTEST_APPLESS_MAIN(TestCore)
+#include "tst_core.moc"
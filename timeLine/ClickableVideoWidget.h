@@ -1,28 +1,170 @@
 #ifndef CLICKABLEVIDEOWIDGET_H
 #define CLICKABLEVIDEOWIDGET_H
 
-#include <QVideoWidget>
+#include <QWidget>
 #include <QMouseEvent>
+#include <QResizeEvent>
+#include <QPainter>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <QImage>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
+#include <functional>
+#include "PerfMetrics.h"
+#include "Trace.h"
+#include "YuvCoefficients.h"
 
 /**
  * @brief ClickableVideoWidget
- * 可點擊的 QVideoWidget 子類別
- * 提供滑鼠點擊事件，並發送相對於 Widget 的座標
+ * 只繪製裁切區域 (ROI) 的影片預覽 Widget
+ *
+ * 由內部的 QVideoSink 接收解碼後的畫面，paintEvent 只把來源影像中的 ROI
+ * 子矩形取樣到固定大小的 Widget 上，不再把整張影格縮放後放進 QScrollArea 平移。
+ * 預覽成本與 Widget (視窗) 大小成正比，與來源解析度無關。
+ *
+ * 設定 ROI 提供者後，每張影格到達時會以該影格的顯示時間戳 (PTS) 重新計算 ROI，
+ * 鏡頭移動與畫面逐幀同步；並量測「影格到達 → 畫面更新完成」的延遲。
+ *
+ * 同時提供滑鼠點擊事件，並發送相對於 Widget 的座標
  */
-class ClickableVideoWidget : public QVideoWidget {
+class ClickableVideoWidget : public QWidget {
     Q_OBJECT
 public:
     /**
      * @brief Constructor
      * @param parent 父 QWidget，預設為 nullptr
      *
-     * 初始化 Widget 並啟用滑鼠追蹤
+     * 建立 QVideoSink 並啟用滑鼠追蹤
      */
     explicit ClickableVideoWidget(QWidget *parent = nullptr)
-        : QVideoWidget(parent)
+        : QWidget(parent), m_sink(new QVideoSink(this))
     {
         // 啟用滑鼠追蹤，即使沒有按鍵也能追蹤滑鼠位置
         setMouseTracking(true);
+
+        // 每次都完整覆蓋整個 Widget，不需要 Qt 先清背景
+        setAttribute(Qt::WA_OpaquePaintEvent);
+
+        connect(m_sink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame &frame) {
+            // 上一張影格還沒畫出就被取代，視為掉幀
+            if (m_latencyPending) PerfMetrics::instance().count("preview.dropped");
+            m_arrival.start();
+            m_latencyPending = true;
+            m_still = QImage();       // 播放器的新畫面取代逐格檢視的靜態影格
+            m_frame = frame;          // QVideoFrame 為共享參考，不會複製像素
+            m_fallbackValid = false;
+            if (m_roiProvider && frame.startTime() >= 0) {
+                m_roi = m_roiProvider(frame.startTime());
+            }
+            update();
+        });
+    }
+
+    /**
+     * @brief ROI 提供者型別
+     * 參數為影格顯示時間 (微秒)，回傳該時間的裁切區域
+     */
+    using RoiProvider = std::function<QRectF(qint64 timeUs)>;
+
+    /**
+     * @brief 設定 ROI 提供者，之後每張影格都依其時間戳更新 ROI
+     */
+    void setRoiProvider(RoiProvider provider) {
+        m_roiProvider = std::move(provider);
+        refreshRoi();
+    }
+
+    /**
+     * @brief 以目前影格的時間戳重新計算 ROI (暫停時調整縮放等情況使用)
+     */
+    void refreshRoi() {
+        const qint64 t = frameTime();
+        if (m_roiProvider && t >= 0) {
+            setRoi(m_roiProvider(t));
+        }
+    }
+
+    /**
+     * @brief 顯示一張已解碼的影格 (逐格檢視 / 反向穿梭，來自 FrameCache)
+     * @param image RGB 影像，與播放器畫面同尺寸
+     * @param timeUs 影格時間 (微秒)，用於計算 ROI
+     * 播放器送來新畫面時自動取消
+     */
+    void showStill(const QImage &image, qint64 timeUs) {
+        m_arrival.start();
+        m_latencyPending = true;
+        m_still = image;
+        m_stillTime = timeUs;
+        if (m_roiProvider) m_roi = m_roiProvider(timeUs);
+        update();
+    }
+
+    /**
+     * @brief 目前影格的顯示時間 (微秒)，沒有影格時為 -1
+     */
+    qint64 frameTime() const {
+        if (!m_still.isNull()) return m_stillTime;
+        return m_frame.isValid() ? m_frame.startTime() : -1;
+    }
+
+    /**
+     * @brief 提供給 QMediaPlayer::setVideoSink 的畫面接收端
+     */
+    QVideoSink *videoSink() const { return m_sink; }
+
+    /**
+     * @brief 設定裁切區域
+     * @param roi 來源影格像素座標中的矩形；空矩形表示顯示整張影格
+     */
+    void setRoi(const QRectF &roi) {
+        if (roi == m_roi) return;
+        m_roi = roi;
+        update();
+    }
+
+    QRectF roi() const { return m_roi; }
+
+    /**
+     * @brief 設定 ROI 所使用的座標尺寸 (原始影片尺寸)
+     * 播放代理檔時影格較小，繪製時依比例把 ROI 換算到影格座標；空尺寸表示與影格相同
+     */
+    void setSourceSize(const QSize &size) {
+        if (size == m_sourceSize) return;
+        m_sourceSize = size;
+        update();
+    }
+
+    /**
+     * @brief 目前影格的來源尺寸 (尚未收到畫面時為空)
+     */
+    QSize frameSize() const {
+        if (!m_still.isNull()) return m_still.size();
+        return m_frame.isValid() ? m_frame.size() : QSize();
+    }
+
+    /**
+     * @brief Widget 座標 → 原始影片座標 (依目前影格的 ROI)
+     * @param pos 相對於 Widget 的座標 (例如 clicked 的位置)
+     * @return 原始影片像素座標；尚未收到畫面時為 (-1, -1)
+     */
+    QPointF mapToSource(const QPoint &pos) const {
+        const QSize fs = frameSize();
+        if (fs.isEmpty()) return QPointF(-1, -1);
+
+        const QRectF src = effectiveRoi();
+        QPointF p(src.x() + (pos.x() + 0.5) * src.width() / qMax(1, width()),
+                  src.y() + (pos.y() + 0.5) * src.height() / qMax(1, height()));
+
+        // 代理影格座標 → 原始影片座標
+        if (!m_sourceSize.isEmpty() && m_sourceSize != fs) {
+            p.rx() *= double(m_sourceSize.width()) / fs.width();
+            p.ry() *= double(m_sourceSize.height()) / fs.height();
+        }
+        return p;
     }
 
 signals:
@@ -32,17 +174,263 @@ signals:
      */
     void clicked(const QPoint &pos);
 
+    /**
+     * @brief correctionRequested 信號：Ctrl + 左鍵點擊，要求從目前影格重新追蹤點擊的人物
+     * 一般點擊與雙擊不發送，避免誤觸啟動耗時的重新追蹤
+     * @param pos 點擊位置，相對於 Widget 的座標
+     */
+    void correctionRequested(const QPoint &pos);
+
+    /**
+     * @brief frameLatency 信號
+     * @param ms 影格到達 sink 到該影格繪製完成的時間 (毫秒)
+     */
+    void frameLatency(double ms);
+
+    /**
+     * @brief painted 信號：每次繪製完成後發送 (用於量測互動到畫面更新的延遲)
+     */
+    void painted();
+
+    /**
+     * @brief viewportResized 信號：預覽窗口尺寸改變
+     */
+    void viewportResized(const QSize &size);
+
 protected:
     /**
      * @brief mousePressEvent
      * @param event QMouseEvent 指標事件
      *
-     * 當滑鼠在 Widget 上按下時發送 clicked 信號
+     * 當滑鼠在 Widget 上按下時發送 clicked 信號；Ctrl + 左鍵另外發送 correctionRequested
      */
     void mousePressEvent(QMouseEvent *event) override {
         // 發送相對於 Widget 自身的座標
         emit clicked(event->pos());
+        if (event->button() == Qt::LeftButton && event->modifiers().testFlag(Qt::ControlModifier))
+            emit correctionRequested(event->pos());
+    }
+
+    /**
+     * @brief mouseDoubleClickEvent
+     * 雙擊的第二下不再當成按下處理 (預設實作會再呼叫 mousePressEvent)，同一個位置只發送一次
+     */
+    void mouseDoubleClickEvent(QMouseEvent *event) override {
+        event->accept();
     }
+
+    /**
+     * @brief paintEvent
+     * 依畫面格式選擇取樣方式，只處理 ROI 範圍內的像素
+     */
+    void paintEvent(QPaintEvent *) override {
+        TRACE_SCOPE("preview.paint", "paint");
+        {
+            QPainter painter(this);
+            paintFrame(painter);
+        }
+
+        if (m_latencyPending) {
+            m_latencyPending = false;
+            emit frameLatency(m_arrival.nsecsElapsed() / 1.0e6);
+            PerfMetrics::instance().record("preview.latency.ms", m_arrival.nsecsElapsed() / 1.0e6);
+            countPresentedFrame();
+        }
+        emit painted();
+    }
+
+    /**
+     * @brief resizeEvent
+     * 通知外部依新尺寸重新計算 ROI (比例需與 Widget 一致)
+     */
+    void resizeEvent(QResizeEvent *event) override {
+        QWidget::resizeEvent(event);
+        emit viewportResized(event->size());
+    }
+
+private:
+    /**
+     * @brief 繪製目前影格的 ROI
+     */
+    void paintFrame(QPainter &painter) {
+        if (!m_still.isNull()) {
+            painter.fillRect(rect(), Qt::black);
+            drawClipped(painter, m_still, effectiveRoi());
+            return;
+        }
+
+        if (!m_frame.isValid()) {
+            painter.fillRect(rect(), Qt::black);
+            return;
+        }
+
+        const QRectF src = effectiveRoi();
+        const auto format = m_frame.pixelFormat();
+
+        if (format == QVideoFrameFormat::Format_NV12 || format == QVideoFrameFormat::Format_NV21
+            || format == QVideoFrameFormat::Format_YUV420P || format == QVideoFrameFormat::Format_YV12) {
+            if (m_frame.map(QVideoFrame::ReadOnly)) {
+                sampleYuv(src);
+                m_frame.unmap();
+                painter.drawImage(0, 0, m_buffer);
+                return;
+            }
+        }
+
+        painter.fillRect(rect(), Qt::black);
+
+        const QImage::Format imageFormat = QVideoFrameFormat::imageFormatFromPixelFormat(format);
+        if (imageFormat != QImage::Format_Invalid && m_frame.map(QVideoFrame::ReadOnly)) {
+            // RGB 類格式：直接包住映射的記憶體，不複製整張影格
+            QImage view(m_frame.bits(0), m_frame.width(), m_frame.height(),
+                        m_frame.bytesPerLine(0), imageFormat);
+            drawClipped(painter, view, src);
+            m_frame.unmap();
+            return;
+        }
+
+        // 其他格式：每張影格只轉換一次
+        if (!m_fallbackValid) {
+            m_fallback = m_frame.toImage();
+            m_fallbackValid = true;
+        }
+        drawClipped(painter, m_fallback, src);
+    }
+
+    /**
+     * @brief 實際使用的 ROI
+     * 沒有設定 ROI 時，以 Widget 比例置中包住整張影格 (等同 letterbox)
+     */
+    QRectF effectiveRoi() const {
+        const QSize fs = frameSize();
+        if (!m_roi.isEmpty()) {
+            if (m_sourceSize.isEmpty() || m_sourceSize == fs) return m_roi;
+
+            // 原始影片座標 → 代理影格座標
+            const double sx = double(fs.width()) / m_sourceSize.width();
+            const double sy = double(fs.height()) / m_sourceSize.height();
+            return QRectF(m_roi.x() * sx, m_roi.y() * sy, m_roi.width() * sx, m_roi.height() * sy);
+        }
+
+        const double fw = fs.width(), fh = fs.height();
+        const double aspect = double(qMax(1, width())) / qMax(1, height());
+        double w = fw, h = fw / aspect;
+        if (h < fh) { h = fh; w = fh * aspect; }
+        return QRectF((fw - w) / 2.0, (fh - h) / 2.0, w, h);
+    }
+
+    /**
+     * @brief 將 src 與影格的交集畫到 Widget 對應位置，超出影格的部分保持黑色
+     */
+    void drawClipped(QPainter &painter, const QImage &image, const QRectF &src) {
+        const QRectF visible = src.intersected(QRectF(0, 0, image.width(), image.height()));
+        if (visible.isEmpty()) return;
+
+        const double sx = width() / src.width();
+        const double sy = height() / src.height();
+        const QRectF target((visible.x() - src.x()) * sx, (visible.y() - src.y()) * sy,
+                            visible.width() * sx, visible.height() * sy);
+        painter.drawImage(target, image, visible);
+    }
+
+    /**
+     * @brief YUV 4:2:0 (NV12/NV21/I420/YV12) 取樣 ROI 並轉成 RGB
+     * 只走訪輸出像素 (Widget 大小)，結果寫入重複使用的 m_buffer
+     */
+    void sampleYuv(const QRectF &src) {
+        const int outW = width(), outH = height();
+        if (m_buffer.size() != size()) {
+            m_buffer = QImage(size(), QImage::Format_RGB32);
+        }
+
+        const int fw = m_frame.width(), fh = m_frame.height();
+        m_xLut.resize(outW);
+        m_yLut.resize(outH);
+        for (int x = 0; x < outW; ++x) {
+            const int sx = qFloor(src.x() + (x + 0.5) * src.width() / outW);
+            m_xLut[x] = (sx >= 0 && sx < fw) ? sx : -1;
+        }
+        for (int y = 0; y < outH; ++y) {
+            const int sy = qFloor(src.y() + (y + 0.5) * src.height() / outH);
+            m_yLut[y] = (sy >= 0 && sy < fh) ? sy : -1;
+        }
+
+        const auto format = m_frame.pixelFormat();
+        const bool semiPlanar = format == QVideoFrameFormat::Format_NV12
+                             || format == QVideoFrameFormat::Format_NV21;
+        const uchar *yPlane = m_frame.bits(0);
+        const int yStride = m_frame.bytesPerLine(0);
+        const uchar *uPlane = m_frame.bits(1);
+        const int uStride = m_frame.bytesPerLine(1);
+        const uchar *vPlane = semiPlanar ? uPlane : m_frame.bits(2);
+        const int vStride = semiPlanar ? uStride : m_frame.bytesPerLine(2);
+
+        // NV21 / YV12 的 U、V 順序相反
+        const bool swapUV = format == QVideoFrameFormat::Format_NV21
+                         || format == QVideoFrameFormat::Format_YV12;
+        const int uOffset = semiPlanar ? (swapUV ? 1 : 0) : 0;
+        const int vOffset = semiPlanar ? (swapUV ? 0 : 1) : 0;
+        if (!semiPlanar && swapUV) qSwap(uPlane, vPlane);
+
+        // 依影格格式的色彩空間與範圍選擇轉換矩陣 (8.8 定點)
+        const YuvCoefficients k = yuvCoefficients(m_frame.surfaceFormat());
+
+        for (int y = 0; y < outH; ++y) {
+            QRgb *out = reinterpret_cast<QRgb *>(m_buffer.scanLine(y));
+            const int sy = m_yLut[y];
+            if (sy < 0) {
+                std::fill(out, out + outW, qRgb(0, 0, 0));
+                continue;
+            }
+            const uchar *yRow = yPlane + sy * yStride;
+            const uchar *uRow = uPlane + (sy / 2) * uStride;
+            const uchar *vRow = vPlane + (sy / 2) * vStride;
+
+            for (int x = 0; x < outW; ++x) {
+                const int sx = m_xLut[x];
+                if (sx < 0) { out[x] = qRgb(0, 0, 0); continue; }
+
+                const int cx = semiPlanar ? (sx & ~1) : (sx / 2);
+                const int c = (yRow[sx] - k.yOffset) * k.y;
+                const int d = uRow[cx + uOffset] - 128;
+                const int e = vRow[cx + vOffset] - 128;
+                const int r = (c + k.rv * e + 128) >> 8;
+                const int g = (c - k.gu * d - k.gv * e + 128) >> 8;
+                const int b = (c + k.bu * d + 128) >> 8;
+                out[x] = qRgb(qBound(0, r, 255), qBound(0, g, 255), qBound(0, b, 255));
+            }
+        }
+    }
+
+    /**
+     * @brief 每秒統計一次實際畫出的影格數 (預覽 fps)
+     */
+    void countPresentedFrame() {
+        if (!m_fpsWindow.isValid()) m_fpsWindow.start();
+        ++m_fpsFrames;
+        const qint64 ms = m_fpsWindow.elapsed();
+        if (ms >= 1000) {
+            PerfMetrics::instance().record("preview.fps", m_fpsFrames * 1000.0 / ms);
+            m_fpsFrames = 0;
+            m_fpsWindow.restart();
+        }
+    }
+
+    QVideoSink *m_sink;          ///< 接收播放器畫面
+    QVideoFrame m_frame;         ///< 最新一張影格 (共享參考)
+    QRectF m_roi;                ///< 原始影片座標中的裁切區域
+    QSize m_sourceSize;          ///< 原始影片尺寸 (ROI 座標系)
+    QImage m_buffer;             ///< YUV 取樣輸出，尺寸等於 Widget，重複使用
+    QImage m_fallback;           ///< 非 YUV / RGB 格式時的轉換結果
+    bool m_fallbackValid = false;
+    QVector<int> m_xLut, m_yLut; ///< 輸出像素到來源像素的對照表
+    RoiProvider m_roiProvider;   ///< 依影格時間戳計算 ROI
+    QImage m_still;              ///< 逐格檢視時顯示的快取影格
+    qint64 m_stillTime = -1;     ///< m_still 的時間 (微秒)
+    QElapsedTimer m_arrival;     ///< 最新影格到達時間
+    bool m_latencyPending = false;
+    QElapsedTimer m_fpsWindow;   ///< 預覽 fps 統計區間
+    int m_fpsFrames = 0;         ///< 區間內畫出的影格數
 };
 
 #endif // CLICKABLEVIDEOWIDGET_H
@@ -0,0 +1,230 @@
+#include "ExportWriter.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStringList>
+#include <QTemporaryFile>
+
+namespace {
+
+/**
+ * @brief 容器可直接封裝 (不需重新編碼) 的音訊格式
+ */
+bool containerAcceptsAudio(const QString &suffix, const QString &codec)
+{
+    static const QStringList mp4 = { "aac", "mp3", "alac", "ac3", "eac3", "opus", "flac" };
+    static const QStringList avi = { "mp3", "ac3", "pcm_s16le", "pcm_u8" };
+    if (suffix == "mkv") return true;
+    if (suffix == "avi") return avi.contains(codec);
+    return mp4.contains(codec);
+}
+
+/**
+ * @brief 影像編碼參數 (依容器)
+ */
+QStringList videoCodecArgs(const QString &suffix)
+{
+    if (suffix == "avi") return { "-c:v", "mjpeg", "-q:v", "3" };
+    return { "-c:v", "libx264", "-preset", "veryfast", "-crf", "18", "-pix_fmt", "yuv420p" };
+}
+
+/**
+ * @brief 原始音軌的輸入與輸出參數
+ * @param inputIndex 音訊來源在 ffmpeg 的輸入編號
+ * @param input 附加的輸入參數 (-ss / -t / -i)
+ * @param output 附加的對應與編碼參數
+ * @return 是否有音軌
+ */
+bool audioArgs(const ExportWriter::Options &options, const QString &suffix, int inputIndex,
+               QStringList &input, QStringList &output)
+{
+    const QString codec = options.audioSource.isEmpty() ? QString()
+                                                        : ExportWriter::probeAudioCodec(options.audioSource);
+    if (codec.isEmpty()) return false;
+
+    // 以輸入端 -ss / -t 裁成與影像相同的範圍
+    if (options.startSec > 0) input << "-ss" << QString::number(options.startSec, 'f', 6);
+    if (options.durationSec > 0) input << "-t" << QString::number(options.durationSec, 'f', 6);
+    input << "-i" << options.audioSource;
+
+    // 容器能直接封裝時複製封包；否則只重新編碼音訊 (仍是同一次輸出)
+    output << "-map" << QString("%1:a:0").arg(inputIndex) << "-c:a";
+    if (containerAcceptsAudio(suffix, codec)) output << "copy";
+    else if (suffix == "avi") output << "pcm_s16le";
+    else output << "aac" << "-b:a" << "192k";
+    output << "-shortest";  // 取消輸出時音訊不超出影像
+    return true;
+}
+
+} // namespace
+
+ExportWriter::ExportWriter() = default;
+
+ExportWriter::~ExportWriter()
+{
+    close();
+}
+
+// -------------------------
+// 音軌偵測
+// -------------------------
+QString ExportWriter::probeAudioCodec(const QString &source)
+{
+    QProcess probe;
+    probe.start("ffprobe", { "-v", "error", "-select_streams", "a:0",
+                             "-show_entries", "stream=codec_name", "-of", "csv=p=0", source });
+    if (!probe.waitForStarted() || !probe.waitForFinished(10000)
+        || probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) {
+        return QString();
+    }
+    return QString::fromUtf8(probe.readAllStandardOutput()).trimmed();
+}
+
+bool ExportWriter::hasFfmpeg()
+{
+    static const bool available = []() {
+        QProcess ffmpeg;
+        ffmpeg.start("ffmpeg", { "-v", "quiet", "-version" });
+        return ffmpeg.waitForStarted() && ffmpeg.waitForFinished(5000)
+               && ffmpeg.exitStatus() == QProcess::NormalExit && ffmpeg.exitCode() == 0;
+    }();
+    return available;
+}
+
+QString ExportWriter::videoProfile(const Options &options)
+{
+    const QString suffix = QFileInfo(options.file).suffix().toLower();
+    return QString("%1|%2x%3|%4|%5").arg(suffix).arg(options.frameSize.width()).arg(options.frameSize.height())
+                                    .arg(options.fps, 0, 'g', 10).arg(videoCodecArgs(suffix).join(' '));
+}
+
+// -------------------------
+// 串接片段
+// -------------------------
+bool ExportWriter::concat(const QStringList &segments, const Options &options, QString *error)
+{
+    // concat demuxer 清單 (單引號需跳脫)
+    QTemporaryFile list;
+    if (!list.open()) {
+        if (error) *error = "無法建立片段清單";
+        return false;
+    }
+    for (QString segment : segments) {
+        segment.replace("'", "'\\''");
+        list.write("file '" + segment.toUtf8() + "'\n");
+    }
+    list.flush();
+
+    const QString suffix = QFileInfo(options.file).suffix().toLower();
+    QStringList args = { "-y", "-v", "error", "-nostats", "-f", "concat", "-safe", "0", "-i", list.fileName() };
+    QStringList audioInput, audioOutput;
+    audioArgs(options, suffix, 1, audioInput, audioOutput);
+    args << audioInput << "-map" << "0:v:0" << "-c:v" << "copy" << audioOutput << options.file;
+
+    QProcess ffmpeg;
+    ffmpeg.start("ffmpeg", args);
+    if (!ffmpeg.waitForStarted() || !ffmpeg.waitForFinished(-1)
+        || ffmpeg.exitStatus() != QProcess::NormalExit || ffmpeg.exitCode() != 0) {
+        if (error) *error = QString::fromUtf8(ffmpeg.readAllStandardError()).trimmed();
+        return false;
+    }
+    return true;
+}
+
+// -------------------------
+// 開啟輸出
+// -------------------------
+bool ExportWriter::open(const Options &options)
+{
+    close();
+    m_error.clear();
+    m_frameBytes = qint64(options.frameSize.width()) * options.frameSize.height() * 3;
+
+    if (openFfmpeg(options)) return true;
+
+    // 沒有 ffmpeg：OpenCV 輸出，沒有音訊
+    m_hasAudio = false;
+    m_fallback.open(options.file.toStdString(), cv::VideoWriter::fourcc('M','J','P','G'),
+                    options.fps, cv::Size(options.frameSize.width(), options.frameSize.height()));
+    if (!m_fallback.isOpened()) {
+        if (m_error.isEmpty()) m_error = "無法初始化輸出！";
+        return false;
+    }
+    return true;
+}
+
+bool ExportWriter::openFfmpeg(const Options &options)
+{
+    const QString suffix = QFileInfo(options.file).suffix().toLower();
+    QStringList audioInput, audioOutput;
+    m_hasAudio = audioArgs(options, suffix, 1, audioInput, audioOutput);
+
+    // 輸入 0：管線送入的 BGR 影格；輸入 1：原始影片的音軌
+    QStringList args = { "-y", "-v", "error", "-nostats",
+                         "-f", "rawvideo", "-pix_fmt", "bgr24",
+                         "-s", QString("%1x%2").arg(options.frameSize.width()).arg(options.frameSize.height()),
+                         "-r", QString::number(options.fps, 'g', 10), "-i", "pipe:0" };
+    args << audioInput << "-map" << "0:v:0" << videoCodecArgs(suffix) << audioOutput << options.file;
+
+    m_ffmpeg = std::make_unique<QProcess>();
+    m_ffmpeg->setStandardOutputFile(QProcess::nullDevice());
+    m_ffmpeg->start("ffmpeg", args);
+    if (!m_ffmpeg->waitForStarted()) {
+        m_ffmpeg.reset();
+        return false;
+    }
+    return true;
+}
+
+// -------------------------
+// 寫入影格
+// -------------------------
+bool ExportWriter::write(const cv::Mat &frame)
+{
+    if (!m_ffmpeg) {
+        if (!m_fallback.isOpened()) return false;
+        m_fallback.write(frame);
+        return true;
+    }
+
+    if (m_ffmpeg->state() != QProcess::Running) {
+        m_error = QString::fromUtf8(m_ffmpeg->readAllStandardError()).trimmed();
+        return false;
+    }
+
+    const cv::Mat data = frame.isContinuous() ? frame : frame.clone();
+    if (qint64(data.total() * data.elemSize()) != m_frameBytes) {
+        m_error = "影格尺寸與輸出不符";
+        return false;
+    }
+    m_ffmpeg->write(reinterpret_cast<const char *>(data.data), m_frameBytes);
+
+    // 最多累積兩張影格在管線緩衝，避免 ffmpeg 較慢時記憶體無限增長
+    while (m_ffmpeg->bytesToWrite() > 2 * m_frameBytes) {
+        if (!m_ffmpeg->waitForBytesWritten(1000) && m_ffmpeg->state() != QProcess::Running) {
+            m_error = QString::fromUtf8(m_ffmpeg->readAllStandardError()).trimmed();
+            return false;
+        }
+    }
+    return true;
+}
+
+// -------------------------
+// 結束輸出
+// -------------------------
+bool ExportWriter::close()
+{
+    if (m_fallback.isOpened()) {
+        m_fallback.release();
+        return true;
+    }
+    if (!m_ffmpeg) return true;
+
+    // 關閉 stdin，ffmpeg 收到 EOF 後寫入檔尾
+    m_ffmpeg->closeWriteChannel();
+    m_ffmpeg->waitForFinished(-1);
+    const bool ok = m_ffmpeg->exitStatus() == QProcess::NormalExit && m_ffmpeg->exitCode() == 0;
+    if (!ok) m_error = QString::fromUtf8(m_ffmpeg->readAllStandardError()).trimmed();
+    m_ffmpeg.reset();
+    return ok;
+}
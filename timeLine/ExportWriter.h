@@ -0,0 +1,103 @@
+#ifndef EXPORTWRITER_H
+#define EXPORTWRITER_H
+
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+class QProcess;
+
+/**
+ * @brief ExportWriter
+ * 校正影片的編碼輸出：一次完成影像編碼與原始音訊封裝
+ *
+ * 優先以管線把 BGR 影格送進 ffmpeg，同時從原始影片直接複製音軌 (-c:a copy，不重新編碼)，
+ * 不需要輸出後再跑一次 ffmpeg 合併音訊。
+ * 只輸出一段範圍時，音訊以相同的起點與長度裁切，與影像對齊。
+ * 找不到 ffmpeg 時改用 OpenCV VideoWriter (MJPG、無音訊)。
+ *
+ * QProcess 只能在建立它的執行緒使用，open / write / close 必須在同一條執行緒呼叫。
+ */
+class ExportWriter {
+public:
+    struct Options {
+        QString file;               ///< 輸出檔 (副檔名決定容器：.mp4 / .mkv / .mov / .avi)
+        QSize frameSize;            ///< 影格尺寸
+        double fps = 30.0;          ///< 影格率
+        QString audioSource;        ///< 音訊來源 (原始影片)；空字串表示不含音訊
+        double startSec = 0.0;      ///< 輸出範圍在原始影片中的起點 (秒)
+        double durationSec = 0.0;   ///< 輸出範圍長度 (秒，0 表示到結尾)
+    };
+
+    ExportWriter();
+    ~ExportWriter();
+
+    ExportWriter(const ExportWriter &) = delete;
+    ExportWriter &operator=(const ExportWriter &) = delete;
+
+    /**
+     * @brief 開啟輸出 (ffmpeg 優先，失敗時改用 OpenCV)
+     * @return 是否成功
+     */
+    bool open(const Options &options);
+
+    /**
+     * @brief 寫入一張影格 (尺寸須與 frameSize 相同，CV_8UC3)
+     * @return 是否成功；ffmpeg 中途結束時回傳 false
+     */
+    bool write(const cv::Mat &frame);
+
+    /**
+     * @brief 結束輸出並等待封裝完成
+     * @return 是否成功
+     */
+    bool close();
+
+    /**
+     * @brief 輸出是否包含原始音訊
+     */
+    bool hasAudio() const { return m_hasAudio; }
+
+    /**
+     * @brief 最後一次失敗的原因 (ffmpeg 錯誤訊息)
+     */
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief 原始影片第一條音軌的編碼名稱 (ffprobe)；沒有音軌或無法讀取時為空字串
+     */
+    static QString probeAudioCodec(const QString &source);
+
+    /**
+     * @brief 系統是否有可用的 ffmpeg (只檢查一次)
+     */
+    static bool hasFfmpeg();
+
+    /**
+     * @brief 影像編碼設定的識別字串 (容器、編碼參數、尺寸、影格率)
+     * 編碼參數改變時字串跟著改變，可作為已輸出片段的快取鍵值
+     */
+    static QString videoProfile(const Options &options);
+
+    /**
+     * @brief 把已編碼的影像片段直接串接 (不重新編碼)，並封裝原始音訊
+     * @param segments 依序排列的片段檔 (編碼設定須相同)
+     * @param options 輸出檔、音訊來源與範圍 (frameSize 不使用)
+     * @param error 失敗原因 (可為 nullptr)
+     * @return 是否成功
+     */
+    static bool concat(const QStringList &segments, const Options &options, QString *error = nullptr);
+
+private:
+    bool openFfmpeg(const Options &options);
+
+    std::unique_ptr<QProcess> m_ffmpeg;     ///< ffmpeg 管線 (stdin 為 rawvideo)
+    cv::VideoWriter m_fallback;             ///< 沒有 ffmpeg 時的 OpenCV 輸出
+    qint64 m_frameBytes = 0;                ///< 每張影格的位元組數
+    bool m_hasAudio = false;
+    QString m_error;
+};
+
+#endif // EXPORTWRITER_H
@@ -0,0 +1,339 @@
+#include "FilmstripWidget.h"
+#include "MediaHash.h"
+#include "Trace.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtMath>
+#include <algorithm>
+#include <functional>
+#include <opencv2/opencv.hpp>
+
+namespace {
+
+constexpr int kThumbHeight = 90;      ///< 磁碟快取的縮圖高度 (與 Widget 大小無關)
+constexpr qint64 kBaseStep = 250;     ///< 最細縮放層級每格 250ms，其餘為 2 的冪次倍
+constexpr int kJpegQuality = 80;
+
+/**
+ * @brief 一格縮圖：tile 為格子對齊的時間 (記憶體快取鍵)，decode 為實際解碼時間 (磁碟快取鍵)
+ */
+struct ThumbRequest {
+    qint64 tile;
+    qint64 decode;
+};
+
+/**
+ * @brief 背景解碼一批縮圖
+ * 先查磁碟快取，沒有才以 OpenCV 跳轉解碼並寫回快取；
+ * 每張完成就送回 GUI 執行緒，世代改變時提早結束。
+ */
+void decodeThumbnails(const QString &source, const QString &cacheDir, const QVector<ThumbRequest> &requests,
+                      quint64 generation, std::shared_ptr<std::atomic<quint64>> current,
+                      FilmstripWidget *target,
+                      const std::function<void(qint64, const QImage &)> &deliver)
+{
+    // 縮圖屬於背景工作，讓出 CPU 給播放
+    QThread::currentThread()->setPriority(QThread::LowPriority);
+
+    cv::VideoCapture cap;
+    cv::Mat frame, small, rgb;
+
+    for (const ThumbRequest &req : requests) {
+        if (current->load() != generation) return;
+
+        const QString file = cacheDir + QString("/%1.jpg").arg(req.decode);
+        QImage image;
+        if (!image.load(file, "JPG")) {
+            TRACE_SCOPE("thumbnail.decode", "decode");
+            if (!cap.isOpened() && !cap.open(source.toStdString())) return;
+
+            cap.set(cv::CAP_PROP_POS_MSEC, static_cast<double>(req.decode));
+            if (!cap.read(frame) || frame.empty()) continue;
+
+            const int thumbW = qMax(1, frame.cols * kThumbHeight / frame.rows);
+            cv::resize(frame, small, cv::Size(thumbW, kThumbHeight), 0, 0, cv::INTER_AREA);
+            cv::cvtColor(small, rgb, cv::COLOR_BGR2RGB);
+            image = QImage(rgb.data, rgb.cols, rgb.rows, static_cast<int>(rgb.step),
+                           QImage::Format_RGB888).copy();
+            image.save(file, "JPG", kJpegQuality);
+        }
+
+        const qint64 tile = req.tile;
+        QMetaObject::invokeMethod(target, [=]() { deliver(tile, image); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+} // namespace
+
+// -------------------------
+// 建構 / 解構
+// -------------------------
+FilmstripWidget::FilmstripWidget(QWidget *parent)
+    : QWidget(parent),
+    m_thumbs(600),
+    m_generation(std::make_shared<std::atomic<quint64>>(0))
+{
+    setFixedHeight(64);
+    setMouseTracking(false);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    m_pool.setMaxThreadCount(2);
+
+    m_requestTimer.setSingleShot(true);
+    m_requestTimer.setInterval(50);
+    connect(&m_requestTimer, &QTimer::timeout, this, &FilmstripWidget::requestVisible);
+}
+
+FilmstripWidget::~FilmstripWidget()
+{
+    // 讓背景工作提早結束，並等待其退出後才釋放
+    ++(*m_generation);
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+// -------------------------
+// 設定影片來源
+// -------------------------
+void FilmstripWidget::setSource(const QString &videoPath, qint64 durationMs)
+{
+    if (videoPath == m_source && durationMs == m_duration) return;
+
+    ++(*m_generation);
+    m_pool.clear();
+    m_thumbs.clear();
+
+    m_source    = videoPath;
+    m_duration  = qMax<qint64>(0, durationMs);
+    m_viewStart = 0;
+    m_viewSpan  = m_duration;
+
+    // 磁碟快取：<cache>/thumbs/<影片雜湊>/<毫秒>.jpg
+    const QString hash = quickMediaHash(videoPath);
+    m_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                 + "/thumbs/" + (hash.isEmpty() ? QString("unknown") : hash);
+    QDir().mkpath(m_cacheDir);
+
+    scheduleRequest();
+    update();
+}
+
+// -------------------------
+// 播放頭
+// -------------------------
+void FilmstripWidget::setPlayhead(qint64 ms)
+{
+    const double oldX = xAt(m_playhead);
+    m_playhead = ms;
+
+    // 播放頭離開檢視範圍時，整頁捲動
+    if (m_viewSpan > 0 && (ms < m_viewStart || ms > m_viewStart + m_viewSpan)) {
+        m_viewStart = qBound<qint64>(0, ms - m_viewSpan / 10, qMax<qint64>(0, m_duration - m_viewSpan));
+        scheduleRequest();
+        update();
+        return;
+    }
+
+    // 只重繪新舊播放頭
+    const double newX = xAt(m_playhead);
+    update(QRect(qFloor(qMin(oldX, newX)) - 2, 0, qCeil(qAbs(newX - oldX)) + 5, height()));
+}
+
+// -------------------------
+// 關鍵幀
+// -------------------------
+void FilmstripWidget::setKeyframes(const QVector<qint64> &keyframes)
+{
+    m_keyframes = keyframes;
+    scheduleRequest();
+}
+
+// -------------------------
+// 座標換算
+// -------------------------
+qint64 FilmstripWidget::tileStep() const
+{
+    const int tiles = qMax(1, width() / tileWidth());
+    qint64 step = kBaseStep;
+    while (step * tiles < m_viewSpan) step *= 2;
+    return step;
+}
+
+int FilmstripWidget::tileWidth() const
+{
+    return qMax(16, (height() - 8) * 16 / 9);
+}
+
+qint64 FilmstripWidget::timeAt(double x) const
+{
+    if (width() <= 0) return m_viewStart;
+    return m_viewStart + static_cast<qint64>(x / width() * m_viewSpan);
+}
+
+double FilmstripWidget::xAt(qint64 ms) const
+{
+    if (m_viewSpan <= 0) return 0;
+    return double(ms - m_viewStart) / m_viewSpan * width();
+}
+
+// -------------------------
+// 背景載入
+// -------------------------
+void FilmstripWidget::scheduleRequest()
+{
+    m_requestTimer.start();
+}
+
+void FilmstripWidget::requestVisible()
+{
+    if (m_source.isEmpty() || m_viewSpan <= 0) return;
+
+    // 新的檢視取代舊請求：尚未開始的工作直接丟棄，執行中的在下一張前結束
+    const quint64 generation = ++(*m_generation);
+    m_pool.clear();
+
+    const qint64 step = tileStep();
+    QVector<qint64> missing;
+    for (qint64 t = (m_viewStart / step) * step; t < m_viewStart + m_viewSpan && t < m_duration; t += step) {
+        if (!m_thumbs.contains(t)) missing.append(t);
+    }
+    if (missing.isEmpty()) return;
+
+    // 由播放頭附近往外載入，漸進顯示
+    const qint64 center = (m_playhead >= m_viewStart && m_playhead <= m_viewStart + m_viewSpan)
+                              ? m_playhead : m_viewStart + m_viewSpan / 2;
+    std::sort(missing.begin(), missing.end(), [center](qint64 a, qint64 b) {
+        return qAbs(a - center) < qAbs(b - center);
+    });
+
+    // 交錯分給每個執行緒一批，各自開一個 VideoCapture
+    const int workers = qMax(1, m_pool.maxThreadCount());
+    QVector<QVector<ThumbRequest>> batches(workers);
+    for (int i = 0; i < missing.size(); ++i) {
+        const qint64 tile = missing[i];
+        qint64 decode = tile;
+        if (!m_keyframes.isEmpty()) {
+            // 對齊到格子內 (或之前) 最近的關鍵幀，跳轉後第一張就是目標
+            auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), tile + step - 1);
+            if (it != m_keyframes.begin()) decode = *(it - 1);
+        }
+        batches[i % workers].append({ tile, decode });
+    }
+
+    auto deliver = [this](qint64 ms, const QImage &image) {
+        onThumbnailReady(ms, image);
+    };
+    for (const auto &batch : batches) {
+        if (batch.isEmpty()) continue;
+        const QString source = m_source, cacheDir = m_cacheDir;
+        auto current = m_generation;
+        m_pool.start([=]() {
+            decodeThumbnails(source, cacheDir, batch, generation, current, this, deliver);
+        });
+    }
+}
+
+void FilmstripWidget::onThumbnailReady(qint64 ms, const QImage &image)
+{
+    if (image.isNull()) return;
+
+    // 舊檢視的結果仍可放入快取，只是不一定在畫面上
+    m_thumbs.insert(ms, new QImage(image));
+
+    const double x = xAt(ms);
+    const double w = double(tileStep()) / qMax<qint64>(1, m_viewSpan) * width();
+    update(QRect(qFloor(x) - 1, 0, qCeil(w) + 2, height()));
+}
+
+// -------------------------
+// 繪製
+// -------------------------
+void FilmstripWidget::paintEvent(QPaintEvent *event)
+{
+    TRACE_SCOPE("filmstrip.paint", "paint");
+    QPainter painter(this);
+    painter.fillRect(event->rect(), QColor(18, 18, 18));
+
+    if (m_viewSpan <= 0) return;
+
+    const qint64 step = tileStep();
+    const double tileW = double(step) / m_viewSpan * width();
+    const int thumbH = height() - 8;
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    const qint64 first = (timeAt(event->rect().left()) / step) * step;
+    const qint64 last  = timeAt(event->rect().right() + 1);
+    for (qint64 t = qMax<qint64>(0, first); t <= last && t < m_duration; t += step) {
+        const QRectF cell(xAt(t) + 1, 4, tileW - 2, thumbH);
+        if (QImage *img = m_thumbs.object(t)) {
+            // 保持比例置中填滿格子
+            const QSizeF fit = QSizeF(img->size()).scaled(cell.size(), Qt::KeepAspectRatioByExpanding);
+            const QRectF src((img->width() - cell.width() * img->width() / fit.width()) / 2, 0,
+                             cell.width() * img->width() / fit.width(), img->height());
+            painter.drawImage(cell, *img, src);
+        } else {
+            painter.fillRect(cell, QColor(40, 40, 40));
+        }
+    }
+
+    // 播放頭
+    painter.setPen(QPen(QColor(0, 188, 212), 2));
+    const double px = xAt(m_playhead);
+    painter.drawLine(QPointF(px, 0), QPointF(px, height()));
+}
+
+// -------------------------
+// 互動
+// -------------------------
+void FilmstripWidget::wheelEvent(QWheelEvent *event)
+{
+    if (m_duration <= 0) return;
+
+    // 以滑鼠位置為中心縮放
+    const double x = event->position().x();
+    const qint64 anchor = timeAt(x);
+    const double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+    const qint64 minSpan = kBaseStep * qMax(1, width() / tileWidth());
+
+    m_viewSpan  = qBound<qint64>(minSpan, static_cast<qint64>(m_viewSpan * factor), m_duration);
+    m_viewStart = qBound<qint64>(0, anchor - static_cast<qint64>(x / width() * m_viewSpan),
+                                 qMax<qint64>(0, m_duration - m_viewSpan));
+
+    scheduleRequest();
+    update();
+    event->accept();
+}
+
+void FilmstripWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_duration > 0) {
+        emit seekRequested(qBound<qint64>(0, timeAt(event->position().x()), m_duration), false);
+    }
+}
+
+void FilmstripWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if ((event->buttons() & Qt::LeftButton) && m_duration > 0) {
+        emit seekRequested(qBound<qint64>(0, timeAt(event->position().x()), m_duration), false);
+    }
+}
+
+void FilmstripWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_duration > 0) {
+        emit seekRequested(qBound<qint64>(0, timeAt(event->position().x()), m_duration), true);
+    }
+}
+
+void FilmstripWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    scheduleRequest();
+}
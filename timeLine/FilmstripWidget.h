@@ -0,0 +1,89 @@
+#ifndef FILMSTRIPWIDGET_H
+#define FILMSTRIPWIDGET_H
+
+#include <QWidget>
+#include <QCache>
+#include <QImage>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief FilmstripWidget
+ * 時間軸上方的縮圖膠卷
+ *
+ * 縮圖在背景執行緒以 OpenCV 解碼，壓縮成 JPEG 存在磁碟快取
+ * (依影片雜湊與時間戳分檔)，只載入目前可見範圍與縮放層級需要的格子。
+ * 縮圖逐張送回 GUI 執行緒，大檔案也會漸進出現而不阻塞播放。
+ * 有關鍵幀索引時，每格改在該格之前最近的關鍵幀取樣，解碼只需一張影格。
+ * 滾輪縮放、點擊或拖曳發送 seekRequested。
+ */
+class FilmstripWidget : public QWidget {
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructor
+     * @param parent 父級 QWidget
+     */
+    explicit FilmstripWidget(QWidget *parent = nullptr);
+    ~FilmstripWidget() override;
+
+    /**
+     * @brief 設定影片來源，重置檢視為整段影片
+     * @param videoPath 影片路徑
+     * @param durationMs 影片長度 (毫秒)
+     */
+    void setSource(const QString &videoPath, qint64 durationMs);
+
+    /**
+     * @brief 更新播放頭位置，超出檢視範圍時自動捲動
+     */
+    void setPlayhead(qint64 ms);
+
+    /**
+     * @brief 設定關鍵幀時間 (毫秒，遞增)，之後的縮圖對齊關鍵幀解碼
+     */
+    void setKeyframes(const QVector<qint64> &keyframes);
+
+signals:
+    /**
+     * @brief 使用者點擊或拖曳膠卷要求跳轉
+     * @param ms 目標時間 (毫秒)
+     * @param exact 放開滑鼠時為 true (精確跳轉)，拖曳中為 false
+     */
+    void seekRequested(qint64 ms, bool exact);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    qint64 tileStep() const;            ///< 目前縮放層級每格代表的時間 (毫秒)
+    int tileWidth() const;              ///< 每格寬度 (像素，維持 16:9)
+    qint64 timeAt(double x) const;      ///< Widget x 座標對應時間
+    double xAt(qint64 ms) const;        ///< 時間對應 Widget x 座標
+    void scheduleRequest();             ///< 合併多次檢視變動為一次載入請求
+    void requestVisible();              ///< 對可見但尚未載入的格子發出背景解碼
+    void onThumbnailReady(qint64 ms, const QImage &image); ///< 縮圖送達 (GUI 執行緒)
+
+    QString m_source;                   ///< 影片路徑
+    QString m_cacheDir;                 ///< 此影片的磁碟快取資料夾
+    qint64 m_duration = 0;              ///< 影片長度 (毫秒)
+    qint64 m_viewStart = 0;             ///< 檢視起點 (毫秒)
+    qint64 m_viewSpan = 0;              ///< 檢視長度 (毫秒)
+    qint64 m_playhead = 0;              ///< 播放頭 (毫秒)
+    QVector<qint64> m_keyframes;        ///< 關鍵幀時間，空表示依格點時間解碼
+
+    QCache<qint64, QImage> m_thumbs;    ///< 記憶體快取 (key = 對齊後的時間戳)
+    QThreadPool m_pool;                 ///< 縮圖解碼執行緒
+    QTimer m_requestTimer;              ///< 請求合併計時器
+    std::shared_ptr<std::atomic<quint64>> m_generation; ///< 檢視世代，舊工作據此提早結束
+};
+
+#endif // FILMSTRIPWIDGET_H
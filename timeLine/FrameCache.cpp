@@ -0,0 +1,243 @@
+#include "FrameCache.h"
+#include "Trace.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+namespace {
+constexpr int kBackwardChunk = 30;  ///< 沒有關鍵幀索引時，反向一次往回解碼的影格數
+}
+
+// -------------------------
+// 建構 / 解構
+// -------------------------
+FrameCache::FrameCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+FrameCache::~FrameCache()
+{
+    close();
+}
+
+// -------------------------
+// 開啟 / 關閉
+// -------------------------
+bool FrameCache::open(const QString &videoPath)
+{
+    close();
+
+    // 先讀取基本資訊，解碼執行緒再開自己的 VideoCapture
+    cv::VideoCapture probe(videoPath.toStdString());
+    if (!probe.isOpened()) return false;
+
+    m_source     = videoPath;
+    m_fps        = probe.get(cv::CAP_PROP_FPS) > 0 ? probe.get(cv::CAP_PROP_FPS) : 30.0;
+    m_frameCount = static_cast<int>(probe.get(cv::CAP_PROP_FRAME_COUNT));
+    // 與 store() 的 Format_RGB888 影像相同：每列補齊到 4 位元組
+    const qint64 width = static_cast<qint64>(probe.get(cv::CAP_PROP_FRAME_WIDTH));
+    m_frameBytes = ((width * 3 + 3) & ~qint64(3)) * static_cast<qint64>(probe.get(cv::CAP_PROP_FRAME_HEIGHT));
+    probe.release();
+
+    m_stop = false;
+    m_cursor = 0;
+    m_direction = 1;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("FrameCacheDecoder");
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void FrameCache::close()
+{
+    if (m_thread) {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_stop = true;
+            m_wake.wakeAll();
+        }
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    m_frames.clear();
+    m_keyframes.clear();
+    m_bytes = 0;
+}
+
+// -------------------------
+// 設定
+// -------------------------
+void FrameCache::setMemoryBudget(qint64 bytes)
+{
+    QMutexLocker lock(&m_mutex);
+    m_budget = qMax<qint64>(bytes, m_frameBytes * 2);
+    evict();
+    m_wake.wakeAll();
+}
+
+void FrameCache::setKeyframes(const QVector<qint64> &keyframesMs)
+{
+    QMutexLocker lock(&m_mutex);
+    m_keyframes.clear();
+    for (qint64 ms : keyframesMs) m_keyframes.append(msToFrame(ms));
+}
+
+void FrameCache::setCursor(int index, int direction)
+{
+    QMutexLocker lock(&m_mutex);
+    m_cursor = qBound(0, index, qMax(0, m_frameCount.load() - 1));
+    m_direction = direction >= 0 ? 1 : -1;
+    evict();
+    m_wake.wakeAll();
+}
+
+// -------------------------
+// 查詢
+// -------------------------
+QImage FrameCache::frame(int index) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_frames.value(index);
+}
+
+qint64 FrameCache::frameToMs(int index) const
+{
+    return static_cast<qint64>(index * 1000.0 / m_fps + 0.5);
+}
+
+int FrameCache::msToFrame(qint64 ms) const
+{
+    return static_cast<int>(ms * m_fps / 1000.0 + 0.5);
+}
+
+int FrameCache::framesInBudget() const
+{
+    return m_frameBytes > 0 ? static_cast<int>(qMax<qint64>(2, m_budget / m_frameBytes)) : 2;
+}
+
+// -------------------------
+// 預先解碼視窗：方向前方 3/4，後方 1/4
+// -------------------------
+int FrameCache::nextMissing() const
+{
+    const int capacity = framesInBudget();
+    const int ahead  = capacity * 3 / 4;
+    const int behind = capacity - ahead - 1;
+    const int last   = m_frameCount - 1;
+
+    // 先補方向前方，再補後方
+    for (int i = 0; i <= ahead; ++i) {
+        int idx = m_cursor + i * m_direction;
+        if (idx < 0 || idx > last) break;
+        if (!m_frames.contains(idx)) return idx;
+    }
+    for (int i = 1; i <= behind; ++i) {
+        int idx = m_cursor - i * m_direction;
+        if (idx < 0 || idx > last) break;
+        if (!m_frames.contains(idx)) return idx;
+    }
+    return -1;
+}
+
+// -------------------------
+// 淘汰離游標最遠的影格
+// -------------------------
+void FrameCache::evict()
+{
+    while (m_bytes > m_budget && !m_frames.isEmpty()) {
+        auto first = m_frames.begin();
+        auto last  = std::prev(m_frames.end());
+        auto victim = (qAbs(first.key() - m_cursor) >= qAbs(last.key() - m_cursor)) ? first : last;
+        m_bytes -= victim.value().sizeInBytes();
+        m_frames.erase(victim);
+    }
+}
+
+void FrameCache::store(int index, const QImage &image)
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_frames.contains(index)) return;
+
+        // 預算視窗以實際影像大小計算，否則估計偏小時剛解碼的影格會立刻被淘汰又重新解碼
+        if (image.sizeInBytes() > m_frameBytes) {
+            m_frameBytes = image.sizeInBytes();
+            m_budget = qMax(m_budget, m_frameBytes * 2);
+        }
+        m_frames.insert(index, image);
+        m_bytes += image.sizeInBytes();
+        evict();
+        if (!m_frames.contains(index)) return; // 超出視窗，立即被淘汰
+    }
+    emit frameReady(index);
+}
+
+// -------------------------
+// 解碼執行緒
+// -------------------------
+void FrameCache::run()
+{
+    cv::VideoCapture cap(m_source.toStdString());
+    if (!cap.isOpened()) return;
+
+    cv::Mat bgr, rgb;
+    int position = 0; // 下一次 read() 會得到的影格
+
+    auto decodeNext = [&](int index) -> bool {
+        TRACE_SCOPE("framecache.decode", "decode");
+        if (!cap.read(bgr) || bgr.empty()) return false;
+        cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+        QImage image(rgb.data, rgb.cols, rgb.rows, static_cast<int>(rgb.step), QImage::Format_RGB888);
+        store(index, image.copy());
+        position = index + 1;
+        return true;
+    };
+
+    while (true) {
+        int missing, direction, keyframeStart = -1;
+        {
+            QMutexLocker lock(&m_mutex);
+            while (!m_stop && (missing = nextMissing()) < 0) {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_stop) return;
+            direction = m_direction;
+
+            if (direction < 0 && !m_keyframes.isEmpty()) {
+                auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), missing);
+                if (it != m_keyframes.begin()) keyframeStart = *(it - 1);
+            }
+        }
+
+        if (direction > 0 || missing == position) {
+            // 往前：接續讀取，只有不連續時才跳轉
+            if (missing != position) cap.set(cv::CAP_PROP_POS_FRAMES, missing);
+            position = missing;
+            if (!decodeNext(missing)) {
+                QMutexLocker lock(&m_mutex);
+                m_frameCount = qMin(m_frameCount.load(), missing); // 實際影格數比標頭少
+            }
+            continue;
+        }
+
+        // 往後：從 GOP 起點 (或固定段落) 解碼到 missing，整段存入
+        int start = keyframeStart >= 0 ? keyframeStart : qMax(0, missing - kBackwardChunk + 1);
+        if (start != position) cap.set(cv::CAP_PROP_POS_FRAMES, start);
+        position = start;
+        for (int idx = start; idx <= missing; ++idx) {
+            {
+                QMutexLocker lock(&m_mutex);
+                if (m_stop) return;
+            }
+            if (!decodeNext(idx)) {
+                QMutexLocker lock(&m_mutex);
+                m_frameCount = qMin(m_frameCount.load(), idx);
+                break;
+            }
+        }
+    }
+}
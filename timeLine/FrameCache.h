@@ -0,0 +1,108 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <QObject>
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief FrameCache
+ * 已解碼影格的有界快取，供逐格檢視與反向穿梭 (J/K/L) 使用
+ *
+ * 獨立的解碼執行緒 (OpenCV) 依游標與方向預先解碼：
+ * 往前時接續讀取；往後時從前一個關鍵幀解碼一整段再存入，
+ * 所以在快取視窗內前後逐格都是即時的。
+ * 記憶體用量受預算限制，超出時淘汰離游標最遠的影格。
+ */
+class FrameCache : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructor
+     * @param parent 父級 QObject
+     */
+    explicit FrameCache(QObject *parent = nullptr);
+    ~FrameCache() override;
+
+    /**
+     * @brief 開啟影片並啟動解碼執行緒
+     * @param videoPath 影片路徑
+     * @return 是否成功開啟
+     */
+    bool open(const QString &videoPath);
+
+    /**
+     * @brief 停止解碼執行緒並清空快取
+     */
+    void close();
+
+    /**
+     * @brief 設定記憶體預算 (位元組)，立即淘汰超出的影格
+     */
+    void setMemoryBudget(qint64 bytes);
+
+    /**
+     * @brief 設定關鍵幀時間 (毫秒)，反向解碼時由此對齊起點
+     */
+    void setKeyframes(const QVector<qint64> &keyframesMs);
+
+    /**
+     * @brief 移動游標並指定預先解碼方向
+     * @param index 目前影格編號
+     * @param direction +1 往後播放方向，-1 反向
+     */
+    void setCursor(int index, int direction);
+
+    /**
+     * @brief 取得快取中的影格
+     * @return 影格影像；尚未解碼時為空 (之後會發送 frameReady)
+     */
+    QImage frame(int index) const;
+
+    double fps() const { return m_fps; }
+    int frameCount() const { return m_frameCount; }
+    bool isOpen() const { return m_thread != nullptr; }
+
+    /**
+     * @brief 影格編號與時間 (毫秒) 互換
+     */
+    qint64 frameToMs(int index) const;
+    int msToFrame(qint64 ms) const;
+
+signals:
+    /**
+     * @brief 影格解碼完成並放入快取 (由解碼執行緒發送，請以 queued 連接)
+     */
+    void frameReady(int index);
+
+private:
+    void run();                             ///< 解碼執行緒主迴圈
+    int nextMissing() const;                ///< 依游標與方向找出下一個需要解碼的影格 (需持鎖)
+    void store(int index, const QImage &image);
+    void evict();                           ///< 淘汰超出預算的影格 (需持鎖)
+    int framesInBudget() const;             ///< 預算可容納的影格數 (需持鎖)
+
+    QString m_source;                       ///< 影片路徑
+    double m_fps = 30.0;                    ///< 影片幀率
+    std::atomic<int> m_frameCount{0};       ///< 總影格數 (解碼執行緒可能下修，GUI 執行緒不加鎖讀取)
+    qint64 m_frameBytes = 0;                ///< 單張影格大小
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;                  ///< 游標移動或關閉時喚醒解碼執行緒
+    QThread *m_thread = nullptr;            ///< 解碼執行緒
+    bool m_stop = false;
+
+    QMap<int, QImage> m_frames;             ///< 影格編號 → 影像
+    qint64 m_bytes = 0;                     ///< 目前快取用量
+    qint64 m_budget = 512LL * 1024 * 1024;  ///< 記憶體預算
+    int m_cursor = 0;                       ///< 目前影格
+    int m_direction = 1;                    ///< 預先解碼方向
+    QVector<int> m_keyframes;               ///< 關鍵幀影格編號 (遞增)
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,112 @@
+#include "KeyframeIndex.h"
+#include <QDataStream>
+#include <QFile>
+#include <QProcess>
+#include <algorithm>
+
+namespace {
+constexpr quint32 kMagic   = 0x4B464958; // 'KFIX'
+constexpr quint32 kVersion = 1;
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_0; ///< 固定序列化格式，不隨 Qt 升級改變
+}
+
+// -------------------------
+// 建立索引 (ffprobe 封包旗標)
+// -------------------------
+KeyframeIndex KeyframeIndex::build(const QString &videoPath, const std::atomic_bool &cancel)
+{
+    KeyframeIndex index;
+
+    // 只讀封包 (pts_time, flags)，不解碼，K 旗標即為關鍵幀
+    QProcess probe;
+    probe.start("ffprobe", { "-v", "error", "-select_streams", "v:0",
+                             "-show_entries", "packet=pts_time,flags",
+                             "-of", "csv=p=0", videoPath });
+    if (!probe.waitForStarted()) return index;
+    while (!probe.waitForFinished(200)) {
+        if (cancel) {
+            probe.kill();
+            probe.waitForFinished();
+            return index;
+        }
+    }
+    if (probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) return index;
+
+    while (probe.canReadLine()) {
+        const QByteArray line = probe.readLine().trimmed();
+        const QList<QByteArray> parts = line.split(',');
+        if (parts.size() < 2 || !parts[1].contains('K')) continue;
+
+        bool ok = false;
+        const double sec = parts[0].toDouble(&ok);
+        if (ok) index.m_times.append(static_cast<qint64>(sec * 1000.0 + 0.5));
+    }
+
+    // 封包為解碼順序，排序後去除重複
+    std::sort(index.m_times.begin(), index.m_times.end());
+    index.m_times.erase(std::unique(index.m_times.begin(), index.m_times.end()), index.m_times.end());
+    return index;
+}
+
+// -------------------------
+// 讀寫索引檔
+// -------------------------
+bool KeyframeIndex::load(const QString &file, const QString &mediaHash)
+{
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    return load(&f, mediaHash);
+}
+
+bool KeyframeIndex::save(const QString &file, const QString &mediaHash) const
+{
+    QFile f(file);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    return save(&f, mediaHash);
+}
+
+bool KeyframeIndex::load(QIODevice *device, const QString &mediaHash)
+{
+    QDataStream in(device);
+    in.setVersion(kStreamVersion);
+    quint32 magic = 0, version = 0;
+    QString hash;
+    QVector<qint64> times;
+    in >> magic >> version >> hash >> times;
+
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion
+        || hash != mediaHash) {
+        return false;
+    }
+    m_times = times;
+    return true;
+}
+
+bool KeyframeIndex::save(QIODevice *device, const QString &mediaHash) const
+{
+    QDataStream out(device);
+    out.setVersion(kStreamVersion);
+    out << kMagic << kVersion << mediaHash << m_times;
+    return out.status() == QDataStream::Ok;
+}
+
+// -------------------------
+// 查詢
+// -------------------------
+qint64 KeyframeIndex::nearest(qint64 ms) const
+{
+    if (m_times.isEmpty()) return ms;
+
+    auto it = std::lower_bound(m_times.begin(), m_times.end(), ms);
+    if (it == m_times.end()) return m_times.last();
+    if (it == m_times.begin()) return *it;
+    return (ms - *(it - 1) <= *it - ms) ? *(it - 1) : *it;
+}
+
+qint64 KeyframeIndex::floor(qint64 ms) const
+{
+    if (m_times.isEmpty()) return ms;
+
+    auto it = std::upper_bound(m_times.begin(), m_times.end(), ms);
+    return (it == m_times.begin()) ? *it : *(it - 1);
+}
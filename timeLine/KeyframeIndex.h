@@ -0,0 +1,63 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief KeyframeIndex
+ * 影片的關鍵幀 (GOP 起點) 時間索引
+ *
+ * 每支影片只建立一次 (ffprobe 讀封包旗標，不需解碼)，
+ * 以二進位檔存在追蹤資料旁，並以影片雜湊驗證是否對應同一支影片。
+ * 拖曳時間軸時用來把跳轉對齊到最近的關鍵幀。
+ */
+class KeyframeIndex {
+public:
+    /**
+     * @brief 以 ffprobe 掃描影片封包建立索引 (阻塞，請在背景執行緒呼叫)
+     * @param videoPath 影片路徑
+     * @param cancel 設為 true 時終止 ffprobe 並回傳空索引
+     * @return 關鍵幀索引；ffprobe 不可用、失敗或取消時為空
+     */
+    static KeyframeIndex build(const QString &videoPath, const std::atomic_bool &cancel);
+
+    /**
+     * @brief 讀取索引檔
+     * @param file 索引檔路徑
+     * @param mediaHash 預期的影片雜湊，不符時視為失效
+     * @return 是否成功
+     */
+    bool load(const QString &file, const QString &mediaHash);
+
+    /**
+     * @brief 寫入索引檔
+     */
+    bool save(const QString &file, const QString &mediaHash) const;
+
+    /**
+     * @brief 以相同格式從任意裝置讀寫 (專案檔內嵌段落使用)
+     */
+    bool load(QIODevice *device, const QString &mediaHash);
+    bool save(QIODevice *device, const QString &mediaHash) const;
+
+    /**
+     * @brief 最接近 ms 的關鍵幀時間；索引為空時原樣回傳
+     */
+    qint64 nearest(qint64 ms) const;
+
+    /**
+     * @brief 不晚於 ms 的最後一個關鍵幀時間；索引為空時原樣回傳
+     */
+    qint64 floor(qint64 ms) const;
+
+    bool isEmpty() const { return m_times.isEmpty(); }
+    const QVector<qint64> &times() const { return m_times; }
+
+private:
+    QVector<qint64> m_times;    ///< 遞增排序的關鍵幀時間 (毫秒)
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -0,0 +1,126 @@
+#include "LiveTracker.h"
+#include "PerfMetrics.h"
+#include "Trace.h"
+#include "VideoFrameMat.h"
+#include <QMutexLocker>
+#include <utility>
+
+namespace {
+constexpr qint64 kStatsIntervalNs = 1000LL * 1000 * 1000;   ///< 吞吐量統計間隔 (1 秒)
+}
+
+// -------------------------
+// 建構 / 解構
+// -------------------------
+LiveTracker::LiveTracker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+LiveTracker::~LiveTracker()
+{
+    stop();
+}
+
+// -------------------------
+// 啟動 / 停止
+// -------------------------
+bool LiveTracker::start(const QString &modelPath, QString *error)
+{
+    stop();
+    if (!m_detector.load(modelPath, error)) return false;
+
+    m_stop = false;
+    m_pending = QVideoFrame();
+    m_submitted = m_dropped = 0;
+    m_clock.start();
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("LiveTracker");
+    m_thread->start();
+    return true;
+}
+
+void LiveTracker::stop()
+{
+    if (!m_thread) return;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stop = true;
+        m_pending = QVideoFrame();
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+// -------------------------
+// 送入影格 (單格信箱)
+// -------------------------
+void LiveTracker::submit(const QVideoFrame &frame)
+{
+    if (!m_thread || !frame.isValid()) return;
+
+    QMutexLocker lock(&m_mutex);
+    if (m_pending.isValid()) ++m_dropped;   // 上一格還沒輪到就被取代
+    m_pending = frame;
+    m_pendingAt = m_clock.nsecsElapsed();
+    ++m_submitted;
+    m_wake.wakeOne();
+}
+
+// -------------------------
+// 追蹤執行緒
+// -------------------------
+void LiveTracker::run()
+{
+    cv::Mat bgr;                        ///< 重複使用的轉換緩衝
+    qint64 windowStart = m_clock.nsecsElapsed();
+    qint64 windowSubmitted = 0, processed = 0;
+
+    while (true) {
+        QVideoFrame frame;
+        qint64 submittedAt = 0;
+        {
+            QMutexLocker lock(&m_mutex);
+            while (!m_stop && !m_pending.isValid()) m_wake.wait(&m_mutex);
+            if (m_stop) return;
+            frame = std::exchange(m_pending, QVideoFrame());
+            submittedAt = m_pendingAt;
+        }
+
+        // 映射後只轉換一次 BGR；VideoFrameMat 離開作用域即解除映射，解碼緩衝盡早歸還播放器
+        QSize frameSize;
+        {
+            TRACE_SCOPE("tracker.convert", "tracker");
+            VideoFrameMat mat(frame);
+            if (!mat.toBgr(bgr)) continue;
+            frameSize = QSize(bgr.cols, bgr.rows);
+        }
+
+        const QVector<PersonDetector::Detection> found = m_detector.detect(bgr);
+        const qint64 done = m_clock.nsecsElapsed();
+        PerfMetrics::instance().record("tracker.latency.ms", (done - submittedAt) / 1.0e6);
+        if (!found.isEmpty()) emit detected(frame.startTime(), found.first().box, frameSize);
+        ++processed;
+
+        // 每秒回報一次：實際處理的影格率 vs 播放器送入的影格率
+        if (done - windowStart >= kStatsIntervalNs) {
+            qint64 submitted, dropped;
+            {
+                QMutexLocker lock(&m_mutex);
+                submitted = m_submitted;
+                dropped = m_dropped;
+            }
+            const double seconds = (done - windowStart) / 1.0e9;
+            const double trackerFps = processed / seconds;
+            const double playbackFps = (submitted - windowSubmitted) / seconds;
+            PerfMetrics::instance().record("tracker.fps", trackerFps);
+            emit statsUpdated(trackerFps, playbackFps, dropped);
+
+            windowStart = done;
+            windowSubmitted = submitted;
+            processed = 0;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef LIVETRACKER_H
+#define LIVETRACKER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QRectF>
+#include <QSize>
+#include <QThread>
+#include <QVideoFrame>
+#include <QWaitCondition>
+#include "PersonDetector.h"
+
+/**
+ * @brief LiveTracker
+ * 播放中的即時追蹤：播放器 QVideoSink 的影格交給獨立的追蹤執行緒偵測人物
+ *
+ * submit() 只在單格信箱中換上最新影格 (QVideoFrame 為共享參考，不複製像素)，不會阻塞播放；
+ * 追蹤執行緒來不及處理時，信箱中尚未處理的舊影格直接被新影格取代 (計入略過數)，
+ * 所以結果延遲最多約為一次偵測的時間。
+ * 影格由 VideoFrameMat 直接映射，不再另外以 cv::VideoCapture 解碼。
+ */
+class LiveTracker : public QObject {
+    Q_OBJECT
+public:
+    explicit LiveTracker(QObject *parent = nullptr);
+    ~LiveTracker() override;
+
+    /**
+     * @brief 載入模型並啟動追蹤執行緒
+     * @param modelPath YOLOv5 ONNX 模型路徑
+     * @param error 失敗原因 (可為 nullptr)
+     * @return 是否成功
+     */
+    bool start(const QString &modelPath, QString *error = nullptr);
+
+    /**
+     * @brief 停止追蹤執行緒 (等待目前的偵測完成)
+     */
+    void stop();
+
+    bool isRunning() const { return m_thread != nullptr; }
+
+    /**
+     * @brief 送入播放器影格 (GUI 執行緒，立即返回)
+     */
+    void submit(const QVideoFrame &frame);
+
+signals:
+    /**
+     * @brief 偵測到人物 (由追蹤執行緒發送，請以 queued 連接)
+     * @param timeUs 影格時間戳 (微秒)
+     * @param box 人物框 (影格座標)
+     * @param frameSize 影格尺寸 (播放代理檔時小於原始影片)
+     */
+    void detected(qint64 timeUs, const QRectF &box, const QSize &frameSize);
+
+    /**
+     * @brief 每秒一次的吞吐量統計 (由追蹤執行緒發送)
+     * @param trackerFps 實際處理的影格率
+     * @param playbackFps 播放器送入的影格率
+     * @param dropped 累計略過的影格數
+     */
+    void statsUpdated(double trackerFps, double playbackFps, qint64 dropped);
+
+private:
+    void run();                             ///< 追蹤執行緒主迴圈
+
+    PersonDetector m_detector;              ///< 只在追蹤執行緒使用
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;                  ///< 有新影格或停止時喚醒追蹤執行緒
+    QThread *m_thread = nullptr;            ///< 追蹤執行緒
+    QElapsedTimer m_clock;                  ///< 延遲與影格率的計時基準
+    bool m_stop = false;
+    QVideoFrame m_pending;                  ///< 尚未處理的最新影格 (單格信箱)
+    qint64 m_pendingAt = 0;                 ///< 最新影格送入的時間 (m_clock，奈秒)
+    qint64 m_submitted = 0;                 ///< 累計送入的影格數
+    qint64 m_dropped = 0;                   ///< 累計被取代而略過的影格數
+};
+
+#endif // LIVETRACKER_H
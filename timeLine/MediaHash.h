@@ -0,0 +1,64 @@
+#ifndef MEDIAHASH_H
+#define MEDIAHASH_H
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief 影片檔的快速雜湊
+ * @param path 影片路徑
+ * @return SHA-1 十六進位字串；檔案無法開啟時回傳空字串
+ *
+ * 只讀取檔案大小與開頭、中間、結尾各 1MB 計算，
+ * 即使是數 GB 的影片也只需數毫秒，適合作為快取與存檔的鍵值。
+ */
+inline QString quickMediaHash(const QString &path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QString();
+
+    const qint64 chunk = 1 << 20;
+    const qint64 size = f.size();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(size));
+
+    const qint64 offsets[] = { 0, qMax<qint64>(0, size / 2 - chunk / 2), qMax<qint64>(0, size - chunk) };
+    for (qint64 offset : offsets) {
+        f.seek(offset);
+        hash.addData(f.read(chunk));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+/**
+ * @brief 影片檔的完整內容雜湊
+ * @param path 影片路徑
+ * @param cancel 設為 true 時中止
+ * @return SHA-1 十六進位字串；檔案無法開啟、讀取失敗或取消時回傳空字串
+ *
+ * 讀取整個檔案，數 GB 的影片需要數秒，請在背景執行緒呼叫。
+ * quickMediaHash 只取樣部分內容，不同影片可能相同；需要以雜湊判定內容相同時 (影片庫去重) 使用此函式。
+ */
+inline QString fullMediaHash(const QString &path, const std::atomic_bool &cancel)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QString();
+
+    const qint64 chunk = 4 << 20;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint64 done = 0;
+    while (!f.atEnd()) {
+        if (cancel) return QString();
+        const QByteArray data = f.read(chunk);
+        if (data.isEmpty()) break;
+        hash.addData(data);
+        done += data.size();
+    }
+    if (done != f.size()) return QString();
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+#endif // MEDIAHASH_H
@@ -0,0 +1,221 @@
+#include "MediaStore.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <functional>
+
+#include "MediaHash.h"
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(Q_OS_LINUX)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#if defined(Q_OS_MACOS)
+#include <sys/clonefile.h>
+#endif
+
+namespace {
+
+constexpr qint64 kCopyChunk = 4 << 20;  ///< 背景複製每次讀寫 4MB
+const char kIndexFile[] = "/index";     ///< 原檔識別 → 完整內容雜湊，每行「識別 雜湊」，只附加
+
+/**
+ * @brief 寫入時複製 (reflink)：Btrfs / XFS / APFS 上與檔案大小無關
+ */
+bool reflinkFile(const QString &from, const QString &to)
+{
+#if defined(Q_OS_LINUX)
+    const int src = ::open(QFile::encodeName(from).constData(), O_RDONLY);
+    if (src < 0) return false;
+    const int dst = ::open(QFile::encodeName(to).constData(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (dst < 0) {
+        ::close(src);
+        return false;
+    }
+    const bool ok = ::ioctl(dst, FICLONE, src) == 0;
+    ::close(src);
+    ::close(dst);
+    if (!ok) QFile::remove(to);
+    return ok;
+#elif defined(Q_OS_MACOS)
+    return ::clonefile(QFile::encodeName(from).constData(), QFile::encodeName(to).constData(), 0) == 0;
+#else
+    Q_UNUSED(from);
+    Q_UNUSED(to);
+    return false;
+#endif
+}
+
+/**
+ * @brief 硬連結：只用於庫中的唯讀影片 (共用 inode，改寫任一方都會影響另一方)
+ */
+bool hardlinkFile(const QString &from, const QString &to)
+{
+#if defined(Q_OS_WIN)
+    return ::CreateHardLinkW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(to).utf16()),
+                             reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(from).utf16()),
+                             nullptr) != 0;
+#else
+    return ::link(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+}
+
+/**
+ * @brief 庫中的影片設為唯讀：內容定址的檔案不應被改寫 (hardlink 出去的存檔也一併受保護)
+ */
+void makeReadOnly(const QString &path)
+{
+    QFile::setPermissions(path, QFileDevice::ReadOwner | QFileDevice::ReadUser
+                                    | QFileDevice::ReadGroup | QFileDevice::ReadOther);
+}
+
+/**
+ * @brief 分段複製到 .part 再改名，中途取消或失敗不會留下不完整的庫檔案
+ */
+bool copyWithProgress(const QString &from, const QString &to, const std::atomic_bool &cancel,
+                      const std::function<void(qint64, qint64)> &progress)
+{
+    QFile in(from);
+    if (!in.open(QIODevice::ReadOnly)) return false;
+
+    const QString part = to + ".part";
+    QFile out(part);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    const qint64 total = in.size();
+    qint64 done = 0;
+    QByteArray buffer;
+    while (!in.atEnd()) {
+        if (cancel) break;
+        buffer = in.read(kCopyChunk);
+        if (buffer.isEmpty() || out.write(buffer) != buffer.size()) break;
+        done += buffer.size();
+        progress(done, total);
+    }
+    out.close();
+
+    if (done != total || !QFile::rename(part, to)) {
+        QFile::remove(part);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// -------------------------
+// 建構 / 解構
+// -------------------------
+MediaStore::MediaStore(const QString &root, QObject *parent)
+    : QObject(parent),
+    m_root(root),
+    m_cancel(std::make_shared<std::atomic_bool>(false))
+{
+    QDir().mkpath(m_root);
+    m_pool.setMaxThreadCount(1);
+    loadIndex();
+}
+
+MediaStore::~MediaStore()
+{
+    *m_cancel = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+// -------------------------
+// 路徑
+// -------------------------
+QString MediaStore::objectPath(const QString &contentHash, const QString &suffix) const
+{
+    return m_root + "/" + contentHash + (suffix.isEmpty() ? QString() : "." + suffix.toLower());
+}
+
+bool MediaStore::linkStored(const QString &storedPath, const QString &to)
+{
+    return reflinkFile(storedPath, to) || hardlinkFile(storedPath, to);
+}
+
+// -------------------------
+// 原檔索引
+// -------------------------
+QString MediaStore::sourceKey(const QString &mediaHash, const QString &source)
+{
+    const QFileInfo info(source);
+    return mediaHash + ':' + QString::number(info.size()) + ':'
+           + QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+void MediaStore::loadIndex()
+{
+    QFile f(m_root + kIndexFile);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    while (!f.atEnd()) {
+        const QList<QByteArray> fields = f.readLine().trimmed().split(' ');
+        if (fields.size() == 2) m_index.insert(QString::fromLatin1(fields[0]), QString::fromLatin1(fields[1]));
+    }
+}
+
+void MediaStore::remember(const QString &key, const QString &contentHash)
+{
+    if (m_index.value(key) == contentHash) return;
+    m_index.insert(key, contentHash);
+    QFile f(m_root + kIndexFile);
+    if (f.open(QIODevice::Append | QIODevice::Text)) f.write((key + ' ' + contentHash + '\n').toLatin1());
+}
+
+// -------------------------
+// 放入影片庫
+// -------------------------
+void MediaStore::import(const QString &source, const QString &mediaHash)
+{
+    auto finish = [this, mediaHash](const QString &path) {
+        QMetaObject::invokeMethod(this, [=]() { emit imported(mediaHash, path); }, Qt::QueuedConnection);
+    };
+
+    if (mediaHash.isEmpty()) {
+        finish(QString());
+        return;
+    }
+
+    // 完整內容雜湊需要讀完整個檔案：與複製同在背景執行，不阻塞 GUI
+    const QString suffix = QFileInfo(source).suffix();
+    auto cancel = m_cancel;
+    m_pool.start([=]() {
+        // 沒改過的影片已在庫中：不讀檔也不複製
+        const QString key = sourceKey(mediaHash, source);
+        const QString known = m_index.value(key);
+        if (!known.isEmpty() && QFile::exists(objectPath(known, suffix))) {
+            finish(objectPath(known, suffix));
+            return;
+        }
+
+        const QString contentHash = fullMediaHash(source, *cancel);
+        if (*cancel) return;
+        if (contentHash.isEmpty()) {
+            finish(QString());
+            return;
+        }
+
+        // 完整雜湊相同才視為同一支影片；否則 reflink，不支援時複製
+        const QString target = objectPath(contentHash, suffix);
+        auto progress = [=](qint64 done, qint64 total) {
+            QMetaObject::invokeMethod(this, [=]() { emit importProgress(mediaHash, done, total); },
+                                      Qt::QueuedConnection);
+        };
+        const bool existed = QFile::exists(target);
+        const bool ok = existed || reflinkFile(source, target)
+                        || copyWithProgress(source, target, *cancel, progress);
+        if (ok && !existed) makeReadOnly(target);
+        if (ok) remember(key, contentHash);
+        if (!*cancel) finish(ok ? target : QString());
+    });
+}
@@ -0,0 +1,88 @@
+#ifndef MEDIASTORE_H
+#define MEDIASTORE_H
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief MediaStore
+ * 以內容雜湊定址的影片庫，存檔只引用影片而不複製
+ *
+ * 每支影片在庫中只存一份：<root>/<完整內容雜湊>.<副檔名>。
+ * 放入時先在背景計算完整內容雜湊 (取樣的 quickMediaHash 可能碰撞，不用於去重)，
+ * 結果記在 <root>/index (快速雜湊 + 大小 + 修改時間 → 完整雜湊)，同一支沒改過的影片再次放入時
+ * 不再讀整個檔案，只需一次 stat；
+ * 庫中已有相同內容時直接沿用；否則優先使用 reflink (寫入時複製)，檔案系統不支援時才複製並回報進度。
+ * 原檔 → 庫不使用 hardlink：與原檔共用 inode，之後編輯原檔會連帶改到庫中的影片。
+ * 庫中的影片以內容定址且設為唯讀，不會被改寫；存檔資料夾再以 reflink 或 hardlink 指向它，
+ * 同一支影片追蹤多次也不會重複佔用空間。
+ */
+class MediaStore : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructor
+     * @param root 影片庫資料夾
+     * @param parent 父級 QObject
+     */
+    explicit MediaStore(const QString &root, QObject *parent = nullptr);
+    ~MediaStore() override;
+
+    /**
+     * @brief 影片在庫中的路徑 (不論是否已存在)
+     * @param contentHash 完整內容雜湊 (fullMediaHash)
+     * @param suffix 副檔名 (不含點)
+     */
+    QString objectPath(const QString &contentHash, const QString &suffix) const;
+
+    /**
+     * @brief 將影片放入庫中 (非同步)
+     * 索引中已有且庫中存在時隨即完成；否則在背景計算完整內容雜湊，
+     * 庫中已有相同內容或可 reflink 時隨即完成，否則複製，期間發送 importProgress。
+     * 結果一律以 imported 發送 (queued)
+     * @param source 影片路徑
+     * @param mediaHash 呼叫端的影片雜湊 (quickMediaHash)，只用來對應 imported，不作為庫中的位址
+     */
+    void import(const QString &source, const QString &mediaHash);
+
+    /**
+     * @brief 把庫中的影片連結到存檔資料夾，不複製資料：先試 reflink，再試 hardlink (NTFS 等)
+     * 只用於庫中的影片 (唯讀、內容定址，不會被改寫)，原檔請用 import
+     * @param storedPath 庫中的影片 (imported 回報的路徑)
+     * @param to 新路徑 (不可已存在)
+     * @return 是否成功；跨磁碟區或檔案系統不支援時失敗
+     */
+    static bool linkStored(const QString &storedPath, const QString &to);
+
+signals:
+    /**
+     * @brief 背景複製進度
+     */
+    void importProgress(const QString &mediaHash, qint64 done, qint64 total);
+
+    /**
+     * @brief 放入完成
+     * @param storedPath 庫中的影片路徑；失敗或取消時為空字串
+     */
+    void imported(const QString &mediaHash, const QString &storedPath);
+
+private:
+    /**
+     * @brief 原檔識別：快速雜湊 + 大小 + 修改時間 (任何一項改變都重新計算完整雜湊)
+     */
+    static QString sourceKey(const QString &mediaHash, const QString &source);
+
+    void loadIndex();
+    void remember(const QString &key, const QString &contentHash);   ///< 寫入索引 (背景執行緒)
+
+    QString m_root;                         ///< 影片庫資料夾
+    QHash<QString, QString> m_index;        ///< 原檔識別 → 完整內容雜湊 (建構後只在 m_pool 存取)
+    QThreadPool m_pool;                     ///< 背景複製 (一次一個，避免搶磁碟)
+    std::shared_ptr<std::atomic_bool> m_cancel; ///< 解構時中止進行中的複製
+};
+
+#endif // MEDIASTORE_H
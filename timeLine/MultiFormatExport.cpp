@@ -0,0 +1,234 @@
+#include "MultiFormatExport.h"
+#include "ExportWriter.h"
+#include "PerfMetrics.h"
+#include "Trace.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr int kSlots = 4;   ///< 共用影格槽位數 (解碼可以領先最慢版本的影格數)
+
+/**
+ * @brief 解碼端與各版本共用的影格環狀緩衝
+ *
+ * published：已解碼的影格數；consumed[b]：版本 b 已處理完的影格數。
+ * 第 n 張影格放在 slots[n % kSlots]，等所有版本的 consumed 都超過 n - kSlots 才能寫入。
+ */
+struct FrameFanout {
+    cv::Mat slots[kSlots];
+    QMutex mutex;
+    QWaitCondition changed;
+    int published = 0;
+    bool finished = false;          ///< 解碼結束 (讀完、取消或失敗)
+    std::vector<int> consumed;
+    QString error;                  ///< 第一個失敗版本的錯誤訊息
+
+    int slowest() const { return *std::min_element(consumed.begin(), consumed.end()); }
+};
+
+/**
+ * @brief 單一版本：等待新影格 → 裁切 → 縮放 → 編碼
+ * 輸出在本執行緒開啟 (QProcess 不可跨執行緒)；失敗時不再佔用槽位，解碼端看到錯誤後停止
+ */
+void runBranch(FrameFanout &fanout, int branch, const ExportFormat &format, int firstFrame,
+               const ExportWriter::Options &options)
+{
+    ExportWriter writer;
+    auto fail = [&](const QString &message) {
+        QMutexLocker lock(&fanout.mutex);
+        if (fanout.error.isEmpty()) fanout.error = format.name + "：" + message;
+        fanout.consumed[branch] = std::numeric_limits<int>::max();
+        fanout.changed.wakeAll();
+    };
+    if (!writer.open(options)) {
+        fail(writer.errorString());
+        return;
+    }
+
+    const QSizeF maxRoi = format.path.maxRoiSize();
+    cv::Mat cropBuffer(qCeil(maxRoi.height()), qCeil(maxRoi.width()), CV_8UC3);
+    cv::Mat outFrame(format.outputSize.height(), format.outputSize.width(), CV_8UC3);
+    const cv::Size outSize(format.outputSize.width(), format.outputSize.height());
+
+    PerfMetrics &metrics = PerfMetrics::instance();
+    QElapsedTimer stage;
+
+    for (int index = 0;; ++index) {
+        {
+            QMutexLocker lock(&fanout.mutex);
+            while (fanout.published <= index && !fanout.finished) fanout.changed.wait(&fanout.mutex);
+            if (fanout.published <= index) break;
+        }
+
+        // 槽位在本版本 consumed 前不會被覆寫，不需持鎖讀取
+        const cv::Mat &frame = fanout.slots[index % kSlots];
+
+        stage.start();
+        qint64 traceStart = trace::now();
+        const cv::Mat cropped = MultiFormatExport::cropView(frame, format.path.roiAt(firstFrame + index), cropBuffer);
+        cv::resize(cropped, outFrame, outSize);
+        metrics.record("export.branch.scale.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.branch.scale", "export", traceStart);
+
+        stage.start();
+        traceStart = trace::now();
+        const bool written = writer.write(outFrame);
+        metrics.record("export.branch.encode.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.branch.encode", "export", traceStart);
+        if (!written) {
+            fail(writer.errorString());
+            return;
+        }
+
+        QMutexLocker lock(&fanout.mutex);
+        fanout.consumed[branch] = index + 1;
+        fanout.changed.wakeAll();
+    }
+
+    if (!writer.close()) fail(writer.errorString());
+}
+
+} // namespace
+
+// -------------------------
+// 輸出尺寸
+// -------------------------
+QSize MultiFormatExport::outputSize(const QSize &source, double aspect)
+{
+    const int shortSide = qMin(source.width(), source.height());
+    if (shortSide <= 0 || aspect <= 0) return QSize();
+    if (aspect >= 1.0) return QSize(qRound(shortSide * aspect / 2.0) * 2, shortSide / 2 * 2);
+    return QSize(shortSide / 2 * 2, qRound(shortSide / aspect / 2.0) * 2);
+}
+
+// -------------------------
+// 裁切 (輸出共用)
+// -------------------------
+cv::Mat MultiFormatExport::cropView(const cv::Mat &frame, const QRectF &planned, cv::Mat &cropBuffer)
+{
+    if (frame.type() != cropBuffer.type()) cropBuffer.create(cropBuffer.size(), frame.type());
+
+    const QRect roi(qFloor(planned.x()), qFloor(planned.y()),
+                    qMin(qRound(planned.width()), cropBuffer.cols),
+                    qMin(qRound(planned.height()), cropBuffer.rows));
+    cv::Mat cropped = cropBuffer(cv::Rect(0, 0, roi.width(), roi.height()));
+
+    // 裁切區域超出影格時才需要補黑邊
+    const CropClip clip = clipCropRect(roi, QSize(frame.cols, frame.rows));
+    if (clip.source.size() != roi.size()) cropped.setTo(cv::Scalar::all(0));
+    if (!clip.source.isEmpty()) {
+        const QRect &src = clip.source;
+        frame(cv::Rect(src.x(), src.y(), src.width(), src.height()))
+        .copyTo(cropped(cv::Rect(clip.dest.x(), clip.dest.y(), src.width(), src.height())));
+    }
+    return cropped;
+}
+
+// -------------------------
+// 一次解碼、多版本輸出
+// -------------------------
+bool MultiFormatExport::run(const QString &source, const QVector<ExportFormat> &formats,
+                            const ExportRange &range, const std::function<void(int, int)> &progress,
+                            const std::atomic_bool &cancel, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (formats.isEmpty()) return fail("沒有選擇輸出格式");
+
+    cv::VideoCapture cap(source.toStdString());
+    if (!cap.isOpened()) return fail("無法開啟影片！");
+
+    const double fps      = cap.get(cv::CAP_PROP_FPS);
+    const int sourceFrames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+    const int first = sourceFrames > 0 ? qBound(0, range.first, sourceFrames - 1) : qMax(0, range.first);
+
+    // 影格數未知 (部分容器回報 0) 時讀到結尾為止
+    int totalFrames = sourceFrames > 0 ? sourceFrames - first : std::numeric_limits<int>::max();
+    if (range.count >= 0) totalFrames = qMin(totalFrames, range.count);
+    const int progressTotal = totalFrames == std::numeric_limits<int>::max() ? 0 : totalFrames;
+    if (first > 0) cap.set(cv::CAP_PROP_POS_FRAMES, first);
+
+    for (const ExportFormat &format : formats) {
+        if (format.path.isEmpty()) return fail(format.name + "：沒有裁切路徑");
+    }
+
+    FrameFanout fanout;
+    fanout.consumed.assign(formats.size(), 0);
+
+    std::vector<QThread *> threads;
+    for (int b = 0; b < formats.size(); ++b) {
+        // 音訊與影像取相同範圍 (以影格編號換算秒數)
+        ExportWriter::Options options;
+        options.file        = formats[b].file;
+        options.frameSize   = formats[b].outputSize;
+        options.fps         = fps;
+        options.audioSource = source;
+        options.startSec    = fps > 0 ? first / fps : 0.0;
+        options.durationSec = fps > 0 && range.count >= 0 ? totalFrames / fps : 0.0;
+
+        QThread *thread = QThread::create([&fanout, b, &formats, first, options]() {
+            runBranch(fanout, b, formats[b], first, options);
+        });
+        thread->setObjectName("Export-" + formats[b].name);
+        thread->start();
+        threads.push_back(thread);
+    }
+
+    PerfMetrics &metrics = PerfMetrics::instance();
+    QElapsedTimer stage;
+    int index = 0;
+    bool ok = true;
+    while (index < totalFrames) {
+        if (cancel) {
+            ok = false;
+            break;
+        }
+
+        // 等最慢的版本釋放這個槽位；有版本失敗就停止
+        {
+            QMutexLocker lock(&fanout.mutex);
+            while (index - fanout.slowest() >= kSlots && fanout.error.isEmpty()) fanout.changed.wait(&fanout.mutex);
+            if (!fanout.error.isEmpty()) break;
+        }
+
+        // 槽位已無人使用，不持鎖解碼 (尺寸不變時 read 會重複使用緩衝)
+        stage.start();
+        const qint64 traceStart = trace::now();
+        if (!cap.read(fanout.slots[index % kSlots])) break;
+        metrics.record("export.decode.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.decode", "export", traceStart);
+
+        {
+            QMutexLocker lock(&fanout.mutex);
+            fanout.published = ++index;
+            fanout.changed.wakeAll();
+        }
+        if (index % 15 == 0) progress(index, progressTotal);
+    }
+
+    {
+        QMutexLocker lock(&fanout.mutex);
+        fanout.finished = true;
+        fanout.changed.wakeAll();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    if (!ok) return fail("輸出任務已手動停止。");
+    if (!fanout.error.isEmpty()) return fail(fanout.error);
+    progress(index, progressTotal);
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef MULTIFORMATEXPORT_H
+#define MULTIFORMATEXPORT_H
+
+#include <QRectF>
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "CameraPathPlanner.h"
+
+/**
+ * @brief ExportFormat
+ * 一種輸出版本 (橫式、直式、方形...)：自己的比例、裁切路徑與輸出檔
+ */
+struct ExportFormat {
+    QString name;           ///< 顯示名稱 (例如 "16x9")
+    QSize outputSize;       ///< 輸出影格尺寸
+    CameraPath path;        ///< 逐幀裁切區域 (原始影片座標，比例與 outputSize 相同)
+    QString file;           ///< 輸出檔路徑
+};
+
+/**
+ * @brief ExportRange
+ * 輸出範圍 (影格編號，原始影片)
+ */
+struct ExportRange {
+    int first = 0;          ///< 第一張影格
+    int count = -1;         ///< 影格數 (-1 表示到結尾)
+};
+
+/**
+ * @brief MultiFormatExport
+ * 一次解碼、多個版本同時輸出
+ *
+ * 解碼執行緒把每張影格放進固定數量的共用槽位 (環狀緩衝)，
+ * 每個版本各有一條執行緒從槽位讀取、裁切、縮放、編碼。
+ * 槽位只有在所有版本都用完後才會被下一張影格覆寫，最慢的版本決定解碼速度；
+ * 輸出 N 個版本約等於一次解碼加 N 次編碼，而不是 N 次完整輸出。
+ * 每個版本以 ExportWriter 輸出，原始音軌直接封裝進去。
+ */
+class MultiFormatExport {
+public:
+    /**
+     * @brief 常用版本的輸出尺寸：以原始影片短邊為基準，保持偶數
+     * @param source 原始影片尺寸
+     * @param aspect 寬高比 (例如 16/9、9/16、1)
+     */
+    static QSize outputSize(const QSize &source, double aspect);
+
+    /**
+     * @brief 輸出所有版本 (阻塞，請在背景執行緒呼叫)
+     * @param source 原始影片路徑
+     * @param formats 輸出版本
+     * @param range 輸出範圍 (影像與音訊都只取這一段)
+     * @param progress 進度回呼 (已解碼影格數、總影格數，在背景執行緒呼叫)
+     * @param cancel 設為 true 時中止
+     * @param error 失敗原因 (可為 nullptr)
+     * @return 是否全部完成
+     */
+    static bool run(const QString &source, const QVector<ExportFormat> &formats, const ExportRange &range,
+                    const std::function<void(int, int)> &progress,
+                    const std::atomic_bool &cancel, QString *error = nullptr);
+
+    /**
+     * @brief 依規劃的裁切區域取出裁切影像 (超出影格的部分補黑)
+     * @param frame 原始影格
+     * @param planned 裁切區域 (原始影片座標)
+     * @param cropBuffer 依最大裁切區域預先配置的緩衝，回傳值是它左上角的子區域 (不配置記憶體)
+     * @return 裁切影像 (cropBuffer 的 view)
+     */
+    static cv::Mat cropView(const cv::Mat &frame, const QRectF &planned, cv::Mat &cropBuffer);
+};
+
+#endif // MULTIFORMATEXPORT_H
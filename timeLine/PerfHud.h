@@ -0,0 +1,95 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <QWidget>
+#include <QPainter>
+#include <QTimer>
+#include <QFontDatabase>
+#include "PerfMetrics.h"
+
+/**
+ * @brief PerfHud
+ * 顯示 PerfMetrics 滾動百分位數的效能面板
+ *
+ * 疊加模式：半透明、不接收滑鼠，蓋在預覽畫面左上角；
+ * 面板模式：一般 Widget，可放進 Dock。
+ * 只在可見時每 250ms 重繪一次，隱藏時不佔成本。
+ */
+class PerfHud : public QWidget {
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructor
+     * @param overlay 是否為疊加模式
+     * @param parent 父級 QWidget (疊加模式時為被覆蓋的 Widget)
+     */
+    explicit PerfHud(bool overlay, QWidget *parent = nullptr)
+        : QWidget(parent), m_overlay(overlay)
+    {
+        setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        if (m_overlay) {
+            setAttribute(Qt::WA_TransparentForMouseEvents);
+            setAttribute(Qt::WA_NoSystemBackground);
+        }
+
+        m_timer.setInterval(250);
+        connect(&m_timer, &QTimer::timeout, this, &PerfHud::refresh);
+    }
+
+protected:
+    void showEvent(QShowEvent *event) override {
+        QWidget::showEvent(event);
+        refresh();
+        m_timer.start();
+    }
+
+    void hideEvent(QHideEvent *event) override {
+        QWidget::hideEvent(event);
+        m_timer.stop();
+    }
+
+    void paintEvent(QPaintEvent *) override {
+        QPainter painter(this);
+        painter.fillRect(rect(), m_overlay ? QColor(0, 0, 0, 160) : QColor(30, 30, 30));
+        painter.setPen(QColor(0, 230, 118));
+
+        const int lineH = fontMetrics().height();
+        int y = lineH;
+        for (const QString &line : m_lines) {
+            painter.drawText(8, y, line);
+            y += lineH;
+        }
+    }
+
+private:
+    /**
+     * @brief 重新取樣統計並依內容調整大小
+     */
+    void refresh() {
+        m_lines.clear();
+        m_lines << QString("%1 %2 %3 %4 %5").arg("metric", -22).arg("p50", 8).arg("p95", 8)
+                                            .arg("p99", 8).arg("max", 8);
+        for (const auto &s : PerfMetrics::instance().summaries()) {
+            m_lines << QString("%1 %2 %3 %4 %5").arg(s.name, -22)
+                           .arg(s.p50, 8, 'f', 2).arg(s.p95, 8, 'f', 2)
+                           .arg(s.p99, 8, 'f', 2).arg(s.max, 8, 'f', 2);
+        }
+        for (const auto &c : PerfMetrics::instance().counters()) {
+            m_lines << QString("%1 %2").arg(c.first, -22).arg(c.second, 8);
+        }
+
+        const QFontMetrics fm = fontMetrics();
+        int w = 0;
+        for (const QString &line : m_lines) w = qMax(w, fm.horizontalAdvance(line));
+        const QSize hint(w + 16, fm.height() * (m_lines.size() + 1));
+        if (m_overlay) resize(hint);
+        else setMinimumSize(hint);
+        update();
+    }
+
+    bool m_overlay;             ///< 疊加模式
+    QTimer m_timer;             ///< 重繪計時器 (只在可見時執行)
+    QStringList m_lines;        ///< 目前顯示的文字
+};
+
+#endif // PERFHUD_H
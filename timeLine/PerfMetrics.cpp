@@ -0,0 +1,143 @@
+#include "PerfMetrics.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 已排序樣本的百分位數 (最近秩)
+ */
+double percentile(const QVector<double> &sorted, double p)
+{
+    if (sorted.isEmpty()) return 0;
+    const int index = qBound(0, static_cast<int>(p * sorted.size() + 0.5) - 1, int(sorted.size()) - 1);
+    return sorted[index];
+}
+
+} // namespace
+
+PerfMetrics &PerfMetrics::instance()
+{
+    static PerfMetrics metrics;
+    return metrics;
+}
+
+// -------------------------
+// 記錄
+// -------------------------
+void PerfMetrics::record(const char *name, double value)
+{
+    // fromRawData 查詢不配置記憶體；只有第一次出現的名稱才複製
+    const QByteArray key = QByteArray::fromRawData(name, qstrlen(name));
+
+    QMutexLocker lock(&m_mutex);
+    auto it = m_series.find(key);
+    if (it == m_series.end()) {
+        it = m_series.insert(QByteArray(name), Series());
+        it->ring.reserve(kWindow);
+    }
+
+    if (it->ring.size() < kWindow) {
+        it->ring.append(value);
+    } else {
+        it->ring[it->next] = value;
+    }
+    it->next = (it->next + 1) % kWindow;
+    it->total += 1;
+    it->last = value;
+}
+
+void PerfMetrics::count(const char *name, qint64 delta)
+{
+    const QByteArray key = QByteArray::fromRawData(name, qstrlen(name));
+
+    QMutexLocker lock(&m_mutex);
+    auto it = m_counters.find(key);
+    if (it == m_counters.end()) it = m_counters.insert(QByteArray(name), 0);
+    *it += delta;
+}
+
+// -------------------------
+// 統計
+// -------------------------
+QVector<PerfMetrics::Summary> PerfMetrics::summaries() const
+{
+    QVector<Summary> result;
+    QVector<double> sorted;
+
+    QMutexLocker lock(&m_mutex);
+    for (auto it = m_series.constBegin(); it != m_series.constEnd(); ++it) {
+        sorted = it->ring;
+        std::sort(sorted.begin(), sorted.end());
+
+        Summary s;
+        s.name    = QString::fromLatin1(it.key());
+        s.samples = it->total;
+        s.last    = it->last;
+        s.p50     = percentile(sorted, 0.50);
+        s.p95     = percentile(sorted, 0.95);
+        s.p99     = percentile(sorted, 0.99);
+        s.max     = sorted.isEmpty() ? 0 : sorted.last();
+        result.append(s);
+    }
+    lock.unlock();
+
+    std::sort(result.begin(), result.end(), [](const Summary &a, const Summary &b) { return a.name < b.name; });
+    return result;
+}
+
+QVector<QPair<QString, qint64>> PerfMetrics::counters() const
+{
+    QVector<QPair<QString, qint64>> result;
+    {
+        QMutexLocker lock(&m_mutex);
+        for (auto it = m_counters.constBegin(); it != m_counters.constEnd(); ++it) {
+            result.append({ QString::fromLatin1(it.key()), it.value() });
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// -------------------------
+// 輸出
+// -------------------------
+bool PerfMetrics::dump(const QString &path) const
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    const QVector<Summary> series = summaries();
+    const auto counts = counters();
+
+    if (path.endsWith(".json", Qt::CaseInsensitive)) {
+        QJsonObject metrics;
+        for (const Summary &s : series) {
+            metrics[s.name] = QJsonObject{
+                { "samples", s.samples }, { "last", s.last },
+                { "p50", s.p50 }, { "p95", s.p95 }, { "p99", s.p99 }, { "max", s.max },
+            };
+        }
+        QJsonObject countersJson;
+        for (const auto &c : counts) countersJson[c.first] = c.second;
+
+        QJsonObject root{ { "metrics", metrics }, { "counters", countersJson } };
+        return f.write(QJsonDocument(root).toJson()) > 0;
+    }
+
+    QTextStream out(&f);
+    out << "name,samples,last,p50,p95,p99,max\n";
+    for (const Summary &s : series) {
+        out << s.name << ',' << s.samples << ',' << s.last << ','
+            << s.p50 << ',' << s.p95 << ',' << s.p99 << ',' << s.max << '\n';
+    }
+    for (const auto &c : counts) {
+        out << c.first << ',' << c.second << ",,,,,\n";
+    }
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,84 @@
+#ifndef PERFMETRICS_H
+#define PERFMETRICS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief PerfMetrics
+ * 全域效能計數器：具名的滾動取樣視窗 (毫秒、fps 等) 與累計計數
+ *
+ * 每個指標保留最近 kWindow 筆取樣，需要時才排序算百分位數，
+ * 記錄一筆只是加鎖寫入環狀緩衝，可放在繪製與播放路徑上。
+ * 同一組數字供 HUD 顯示，也可在結束時輸出成 CSV / JSON。
+ */
+class PerfMetrics {
+public:
+    static constexpr int kWindow = 1024;    ///< 每個指標保留的取樣數
+
+    /**
+     * @brief 單一指標的滾動統計
+     */
+    struct Summary {
+        QString name;
+        qint64 samples = 0;     ///< 累計取樣數 (不只視窗內)
+        double last = 0;
+        double p50 = 0, p95 = 0, p99 = 0, max = 0; ///< 視窗內統計
+    };
+
+    static PerfMetrics &instance();
+
+    /**
+     * @brief 記錄一筆取樣
+     * @param name 指標名稱 (字串常值，例如 "position.ms")
+     */
+    void record(const char *name, double value);
+
+    /**
+     * @brief 累加計數 (例如掉幀數)
+     */
+    void count(const char *name, qint64 delta = 1);
+
+    QVector<Summary> summaries() const;         ///< 所有指標，依名稱排序
+    QVector<QPair<QString, qint64>> counters() const; ///< 所有計數，依名稱排序
+
+    /**
+     * @brief 輸出所有指標與計數
+     * @param path 副檔名為 .json 時輸出 JSON，其餘輸出 CSV
+     */
+    bool dump(const QString &path) const;
+
+private:
+    PerfMetrics() = default;
+
+    struct Series {
+        QVector<double> ring;   ///< 環狀緩衝
+        int next = 0;           ///< 下一個寫入位置
+        qint64 total = 0;       ///< 累計取樣數
+        double last = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QByteArray, Series> m_series;
+    QHash<QByteArray, qint64> m_counters;
+};
+
+/**
+ * @brief PerfTimer
+ * 在作用域結束時記錄經過時間 (毫秒)
+ */
+class PerfTimer {
+public:
+    explicit PerfTimer(const char *name) : m_name(name) { m_timer.start(); }
+    ~PerfTimer() { PerfMetrics::instance().record(m_name, m_timer.nsecsElapsed() / 1.0e6); }
+
+private:
+    const char *m_name;
+    QElapsedTimer m_timer;
+};
+
+#endif // PERFMETRICS_H
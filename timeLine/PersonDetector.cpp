@@ -0,0 +1,112 @@
+#include "PersonDetector.h"
+#include "Trace.h"
+#include <QFile>
+#include <algorithm>
+
+namespace {
+constexpr int kPersonClass = 0;         ///< COCO 類別 0 = person
+constexpr int kPredictionFields = 5;    ///< cx, cy, w, h, obj，之後接各類別分數
+}
+
+QString PersonDetector::defaultModel()
+{
+    return "../track/models/yolov5s.onnx";
+}
+
+// -------------------------
+// 載入模型
+// -------------------------
+bool PersonDetector::load(const QString &modelPath, QString *error)
+{
+    m_net = cv::dnn::Net();
+    if (!QFile::exists(modelPath)) {
+        if (error) *error = QString("ONNX 模型不存在：%1").arg(modelPath);
+        return false;
+    }
+
+    try {
+        m_net = cv::dnn::readNetFromONNX(modelPath.toStdString());
+    } catch (const cv::Exception &e) {
+        if (error) *error = QString("無法載入模型：%1").arg(QString::fromStdString(e.msg));
+        return false;
+    }
+    if (m_net.empty()) {
+        if (error) *error = QString("無法載入模型：%1").arg(modelPath);
+        return false;
+    }
+    return true;
+}
+
+// -------------------------
+// 偵測
+// -------------------------
+QVector<PersonDetector::Detection> PersonDetector::detect(const cv::Mat &bgr, int maxCount)
+{
+    QVector<Detection> result;
+    if (m_net.empty() || bgr.empty() || maxCount <= 0) return result;
+
+    // letterbox：等比例縮放後置中，補邊值 114
+    const int w = bgr.cols, h = bgr.rows;
+    const double r = std::min(double(m_inputSize) / w, double(m_inputSize) / h);
+    const int newW = qRound(w * r), newH = qRound(h * r);
+    const int padX = (m_inputSize - newW) / 2, padY = (m_inputSize - newH) / 2;
+    {
+        TRACE_SCOPE("detector.preprocess", "tracker");
+        cv::resize(bgr, m_resized, cv::Size(newW, newH), 0, 0, cv::INTER_LINEAR);
+        m_canvas.create(m_inputSize, m_inputSize, CV_8UC3);
+        m_canvas.setTo(cv::Scalar::all(114));
+        m_resized.copyTo(m_canvas(cv::Rect(padX, padY, newW, newH)));
+        cv::dnn::blobFromImage(m_canvas, m_blob, 1.0 / 255.0, cv::Size(), cv::Scalar(), true, false);
+    }
+
+    cv::Mat out;
+    {
+        TRACE_SCOPE("detector.inference", "tracker");
+        m_net.setInput(m_blob);
+        out = m_net.forward();
+    }
+
+    // 輸出 (1, N, 5 + 類別數)
+    if (out.dims != 3 || out.size[2] <= kPredictionFields + kPersonClass) return result;
+    const int rows = out.size[1], fields = out.size[2];
+    const float *pred = out.ptr<float>();
+
+    auto toFrame = [&](const float *p) {
+        const double x1 = qBound(0.0, (p[0] - p[2] / 2 - padX) / r, double(w - 1));
+        const double y1 = qBound(0.0, (p[1] - p[3] / 2 - padY) / r, double(h - 1));
+        const double x2 = qBound(0.0, (p[0] + p[2] / 2 - padX) / r, double(w - 1));
+        const double y2 = qBound(0.0, (p[1] + p[3] / 2 - padY) / r, double(h - 1));
+        return QRectF(QPointF(x1, y1), QPointF(x2, y2));
+    };
+
+    // 單一目標：取 obj * cls 最大者即可，不必做 NMS
+    if (maxCount == 1) {
+        int best = -1;
+        float bestScore = m_confThreshold;
+        for (int i = 0; i < rows; ++i) {
+            const float *p = pred + i * fields;
+            const float score = p[4] * p[kPredictionFields + kPersonClass];
+            if (score >= bestScore) { bestScore = score; best = i; }
+        }
+        if (best >= 0) result.append({ toFrame(pred + best * fields), bestScore });
+        return result;
+    }
+
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    std::vector<int> rowOf;
+    for (int i = 0; i < rows; ++i) {
+        const float *p = pred + i * fields;
+        const float score = p[4] * p[kPredictionFields + kPersonClass];
+        if (score < m_confThreshold) continue;
+        boxes.push_back(cv::Rect(qRound(p[0] - p[2] / 2), qRound(p[1] - p[3] / 2), qRound(p[2]), qRound(p[3])));
+        scores.push_back(score);
+        rowOf.push_back(i);
+    }
+
+    // NMSBoxes 依分數遞減回傳
+    std::vector<int> keep;
+    cv::dnn::NMSBoxes(boxes, scores, m_confThreshold, m_nmsThreshold, keep, 1.0f, maxCount);
+    for (int k : keep) result.append({ toFrame(pred + rowOf[k] * fields), scores[k] });
+    return result;
+}
@@ -0,0 +1,58 @@
+#ifndef PERSONDETECTOR_H
+#define PERSONDETECTOR_H
+
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+
+/**
+ * @brief PersonDetector
+ * YOLOv5 ONNX 人物偵測 (OpenCV DNN)，前處理與後處理與 track/track.py 的 OnnxDetector 相同，
+ * 模型同樣由 yolov5 export.py / calibrate_int8.py 產生
+ *
+ * 不是執行緒安全的：每個執行緒使用自己的實例 (前處理緩衝在呼叫之間重複使用)。
+ */
+class PersonDetector {
+public:
+    /**
+     * @brief 單一偵測結果
+     */
+    struct Detection {
+        QRectF box;         ///< 人物框 (輸入影格座標)
+        float score = 0;    ///< obj * person 類別分數
+    };
+
+    /**
+     * @brief 預設模型位置 (track/models/yolov5s.onnx)
+     */
+    static QString defaultModel();
+
+    /**
+     * @brief 載入模型
+     * @param modelPath ONNX 模型路徑
+     * @param error 失敗原因 (可為 nullptr)
+     * @return 是否成功
+     */
+    bool load(const QString &modelPath, QString *error = nullptr);
+
+    bool isLoaded() const { return !m_net.empty(); }
+
+    /**
+     * @brief 偵測人物
+     * @param bgr BGR 影格
+     * @param maxCount 最多回傳幾個 (1 時直接取最高分，不做 NMS)
+     * @return 依分數遞減的人物框；沒有超過門檻的目標時為空
+     */
+    QVector<Detection> detect(const cv::Mat &bgr, int maxCount = 1);
+
+private:
+    cv::dnn::Net m_net;
+    int m_inputSize = 640;          ///< 模型輸入邊長
+    float m_confThreshold = 0.25f;  ///< 分數門檻 (與 track.py 相同)
+    float m_nmsThreshold = 0.45f;   ///< 多目標時的 NMS IoU 門檻
+    cv::Mat m_resized, m_canvas, m_blob; ///< 前處理緩衝
+};
+
+#endif // PERSONDETECTOR_H
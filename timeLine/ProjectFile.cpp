@@ -0,0 +1,139 @@
+#include "ProjectFile.h"
+#include <QDataStream>
+#include <QSaveFile>
+
+namespace {
+constexpr quint32 kMagic    = 0x4A504C54; // 'TLPJ'
+constexpr quint32 kVersion  = 1;
+constexpr qint64 kPreamble  = 16;         ///< magic + 版本 + 段落表位置
+constexpr qint64 kAlignment = 8;          ///< 段落起點對齊，映射後可直接當 double / qint64 陣列
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_0; ///< 固定標頭 (QString / QVariantMap) 的序列化格式
+}
+
+// -------------------------
+// 開啟 / 關閉
+// -------------------------
+bool ProjectFile::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&m_file);
+    in.setVersion(kStreamVersion);
+    in.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0, version = 0;
+    qint64 tableOffset = 0;
+    in >> magic >> version >> tableOffset;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion
+        || tableOffset < kPreamble || tableOffset > m_file.size()) {
+        close();
+        return false;
+    }
+
+    in >> m_header.mediaHash >> m_header.mediaPath >> m_header.storedMedia >> m_header.settings;
+
+    // 段落表在檔尾，只讀表不讀內容
+    m_file.seek(tableOffset);
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        quint32 tag = 0;
+        Entry entry{};
+        in >> tag >> entry.offset >> entry.size;
+        if (entry.offset < kPreamble || entry.size < 0 || entry.offset + entry.size > tableOffset) continue;
+        m_sections.insert(tag, entry);
+    }
+    if (in.status() != QDataStream::Ok) {
+        close();
+        return false;
+    }
+
+    // 映射失敗 (例如網路磁碟) 時 section() 改為讀檔
+    m_map = m_file.map(0, m_file.size());
+    return true;
+}
+
+void ProjectFile::close()
+{
+    if (m_map) m_file.unmap(m_map);
+    m_map = nullptr;
+    m_file.close();
+    m_header = ProjectHeader();
+    m_sections.clear();
+}
+
+// -------------------------
+// 段落
+// -------------------------
+QByteArray ProjectFile::section(quint32 tag) const
+{
+    auto it = m_sections.constFind(tag);
+    if (it == m_sections.constEnd()) return QByteArray();
+
+    if (m_map) {
+        return QByteArray::fromRawData(reinterpret_cast<const char *>(m_map + it->offset), it->size);
+    }
+
+    QFile &file = const_cast<QFile &>(m_file);
+    file.seek(it->offset);
+    return file.read(it->size);
+}
+
+// -------------------------
+// 寫入
+// -------------------------
+bool ProjectFile::save(const QString &path, const ProjectHeader &header,
+                       const QMap<quint32, QByteArray> &sections)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(kStreamVersion);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    // 前導的段落表位置最後回填
+    out << kMagic << kVersion << qint64(0);
+    out << header.mediaHash << header.mediaPath << header.storedMedia << header.settings;
+
+    QMap<quint32, Entry> table;
+    for (auto it = sections.constBegin(); it != sections.constEnd(); ++it) {
+        const qint64 padding = (kAlignment - file.pos() % kAlignment) % kAlignment;
+        file.write(QByteArray(padding, '\0'));
+        table.insert(it.key(), { file.pos(), it.value().size() });
+        file.write(it.value());
+    }
+
+    const qint64 tableOffset = file.pos();
+    out << quint32(table.size());
+    for (auto it = table.constBegin(); it != table.constEnd(); ++it) {
+        out << it.key() << it->offset << it->size;
+    }
+
+    file.seek(8);
+    out << tableOffset;
+
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool ProjectFile::saveSection(const QString &path, const QString &mediaHash, quint32 tag,
+                              const QByteArray &data)
+{
+    ProjectHeader header;
+    QMap<quint32, QByteArray> sections;
+    {
+        ProjectFile project;
+        if (!project.open(path) || project.header().mediaHash != mediaHash) return false;
+        header = project.header();
+        // section() 指向映射記憶體，關閉前先深複製
+        for (auto it = project.m_sections.constBegin(); it != project.m_sections.constEnd(); ++it) {
+            const QByteArray raw = project.section(it.key());
+            sections.insert(it.key(), QByteArray(raw.constData(), raw.size()));
+        }
+    }
+    sections.insert(tag, data);
+    return save(path, header, sections);
+}
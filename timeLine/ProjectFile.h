@@ -0,0 +1,95 @@
+#ifndef PROJECTFILE_H
+#define PROJECTFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief ProjectHeader
+ * 專案檔的標頭：影片引用與設定，開啟時立即讀取
+ */
+struct ProjectHeader {
+    QString mediaHash;      ///< 原始影片雜湊 (quickMediaHash)
+    QString mediaPath;      ///< 原始影片路徑
+    QString storedMedia;    ///< 影片庫中的路徑 (MediaStore)
+    QVariantMap settings;   ///< 縮放、平滑等參數 ("scale/base"、"scale/manual"、"smoothing/mode" ...)
+};
+
+/**
+ * @brief ProjectFile
+ * 單一檔案的追蹤專案 (.tlproj)，取代「影片 + tracking.csv」資料夾
+ *
+ * 檔案配置：固定前導 (magic、版本、段落表位置) → 標頭 → 各段落 (8 位元組對齊) → 段落表。
+ * 開啟時只讀前導、標頭與段落表，其餘以記憶體映射存取，
+ * 段落在實際用到時才由作業系統分頁載入，大型專案也能在毫秒內開啟。
+ * 段落以四字元標籤識別，讀取端忽略不認得的段落，之後可增加新段落而不改版本。
+ */
+class ProjectFile {
+public:
+    static constexpr quint32 kTrajectory = 0x4A415254; ///< 'TRAJ' 軌跡 (二進位 double 陣列)
+    static constexpr quint32 kKeyframes  = 0x4659454B; ///< 'KEYF' 關鍵幀索引 (KeyframeIndex 格式)
+
+    ProjectFile() = default;
+    ~ProjectFile() { close(); }
+    ProjectFile(const ProjectFile &) = delete;
+    ProjectFile &operator=(const ProjectFile &) = delete;
+
+    /**
+     * @brief 開啟專案：讀取標頭與段落表，映射檔案
+     * @param path 專案檔路徑
+     * @return 是否為有效的專案檔
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief 解除映射並關閉檔案 (之前取得的段落隨之失效)
+     */
+    void close();
+
+    const ProjectHeader &header() const { return m_header; }
+    bool hasSection(quint32 tag) const { return m_sections.contains(tag); }
+
+    /**
+     * @brief 取得段落內容 (不複製，直接指向映射記憶體)
+     * @return 段落資料；不存在時為空，專案關閉後失效
+     */
+    QByteArray section(quint32 tag) const;
+
+    /**
+     * @brief 寫入專案檔 (先寫暫存檔再取代，寫到一半不會損壞舊專案)
+     * @param path 專案檔路徑
+     * @param header 標頭
+     * @param sections 標籤 → 段落資料
+     */
+    static bool save(const QString &path, const ProjectHeader &header,
+                     const QMap<quint32, QByteArray> &sections);
+
+    /**
+     * @brief 只取代既有專案檔中的一個段落，標頭與其他段落原樣保留
+     * 呼叫前請先關閉指向同一檔案的 ProjectFile (Windows 上映射中的檔案無法取代)
+     * @param path 專案檔路徑
+     * @param mediaHash 段落所屬的影片雜湊；與專案標頭不同時不寫入
+     * @param tag 段落標籤
+     * @param data 段落資料
+     * @return 是否成功
+     */
+    static bool saveSection(const QString &path, const QString &mediaHash, quint32 tag,
+                            const QByteArray &data);
+
+private:
+    struct Entry {
+        qint64 offset;
+        qint64 size;
+    };
+
+    QFile m_file;                           ///< 專案檔
+    uchar *m_map = nullptr;                 ///< 整個檔案的映射
+    ProjectHeader m_header;                 ///< 標頭
+    QHash<quint32, Entry> m_sections;       ///< 段落表
+};
+
+#endif // PROJECTFILE_H
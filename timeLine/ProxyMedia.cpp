@@ -0,0 +1,138 @@
+#include "ProxyMedia.h"
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+#include <opencv2/opencv.hpp>
+
+namespace {
+constexpr int kProxyShortSide = 720;    ///< 代理檔短邊
+constexpr int kProxyThreshold = 1080;   ///< 原始影片短邊超過此值才產生代理
+}
+
+// -------------------------
+// 尺寸規則
+// -------------------------
+QSize ProxyMedia::proxySize(const QSize &source)
+{
+    if (!needsProxy(source)) return source;
+
+    const double scale = double(kProxyShortSide) / qMin(source.width(), source.height());
+    return QSize(qRound(source.width() * scale / 2.0) * 2, qRound(source.height() * scale / 2.0) * 2);
+}
+
+bool ProxyMedia::needsProxy(const QSize &source)
+{
+    return source.isValid() && qMin(source.width(), source.height()) > kProxyThreshold;
+}
+
+// -------------------------
+// 快取位置
+// -------------------------
+QString ProxyMedia::cacheDir()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/proxies";
+    QDir().mkpath(dir);
+    return dir;
+}
+
+QString ProxyMedia::find(const QString &mediaHash)
+{
+    if (mediaHash.isEmpty()) return QString();
+    for (const char *ext : { ".mp4", ".avi" }) {
+        const QString path = cacheDir() + "/" + mediaHash + ext;
+        if (QFile::exists(path)) return path;
+    }
+    return QString();
+}
+
+// -------------------------
+// 產生代理檔
+// -------------------------
+QString ProxyMedia::generate(const QString &source, const QString &mediaHash,
+                             const std::function<void(double)> &progress,
+                             const std::atomic_bool &cancel)
+{
+    cv::VideoCapture probe(source.toStdString());
+    if (!probe.isOpened() || mediaHash.isEmpty()) return QString();
+
+    const QSize sourceSize(static_cast<int>(probe.get(cv::CAP_PROP_FRAME_WIDTH)),
+                           static_cast<int>(probe.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    const double fps = probe.get(cv::CAP_PROP_FPS);
+    const double frames = probe.get(cv::CAP_PROP_FRAME_COUNT);
+    probe.release();
+
+    const QSize size = proxySize(sourceSize);
+    const double durationSec = fps > 0 ? frames / fps : 0.0;
+
+    // 先寫暫存檔，完成後才改名，避免半成品被當成代理
+    const QString mp4 = cacheDir() + "/" + mediaHash + ".mp4";
+    if (generateWithFfmpeg(source, mp4 + ".part", size, durationSec, progress, cancel)
+        && QFile::rename(mp4 + ".part", mp4)) {
+        return mp4;
+    }
+    QFile::remove(mp4 + ".part");
+    if (cancel) return QString();
+
+    const QString avi = cacheDir() + "/" + mediaHash + ".avi";
+    if (generateWithOpenCV(source, avi + ".part", size, progress, cancel)
+        && QFile::rename(avi + ".part", avi)) {
+        return avi;
+    }
+    QFile::remove(avi + ".part");
+    return QString();
+}
+
+bool ProxyMedia::generateWithFfmpeg(const QString &source, const QString &out, const QSize &size,
+                                    double durationSec, const std::function<void(double)> &progress,
+                                    const std::atomic_bool &cancel)
+{
+    QProcess ffmpeg;
+    ffmpeg.start("ffmpeg", { "-y", "-v", "error", "-i", source,
+                             "-vf", QString("scale=%1:%2").arg(size.width()).arg(size.height()),
+                             "-c:v", "libx264", "-preset", "veryfast", "-crf", "26",
+                             "-g", "15",                       // 短 GOP，預覽跳轉更快
+                             "-c:a", "aac", "-b:a", "128k",
+                             "-f", "mp4", "-progress", "pipe:1", out });
+    if (!ffmpeg.waitForStarted()) return false;
+
+    // -progress 每秒輸出 out_time_us=...
+    while (!ffmpeg.waitForFinished(200)) {
+        if (cancel) {
+            ffmpeg.kill();
+            ffmpeg.waitForFinished();
+            return false;
+        }
+        while (ffmpeg.canReadLine()) {
+            const QByteArray line = ffmpeg.readLine().trimmed();
+            if (line.startsWith("out_time_us=") && durationSec > 0) {
+                progress(qBound(0.0, line.mid(12).toDouble() / 1.0e6 / durationSec, 1.0));
+            }
+        }
+    }
+    return ffmpeg.exitStatus() == QProcess::NormalExit && ffmpeg.exitCode() == 0;
+}
+
+bool ProxyMedia::generateWithOpenCV(const QString &source, const QString &out, const QSize &size,
+                                    const std::function<void(double)> &progress,
+                                    const std::atomic_bool &cancel)
+{
+    cv::VideoCapture cap(source.toStdString());
+    if (!cap.isOpened()) return false;
+
+    const double fps = cap.get(cv::CAP_PROP_FPS);
+    const double total = qMax(1.0, cap.get(cv::CAP_PROP_FRAME_COUNT));
+    cv::VideoWriter writer(out.toStdString(), cv::VideoWriter::fourcc('M','J','P','G'),
+                           fps, cv::Size(size.width(), size.height()));
+    if (!writer.isOpened()) return false;
+
+    cv::Mat frame, small;
+    int index = 0;
+    while (cap.read(frame)) {
+        if (cancel) return false;
+        cv::resize(frame, small, cv::Size(size.width(), size.height()), 0, 0, cv::INTER_AREA);
+        writer.write(small);
+        if (++index % 30 == 0) progress(qMin(1.0, index / total));
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef PROXYMEDIA_H
+#define PROXYMEDIA_H
+
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief ProxyMedia
+ * 高解析度影片 (例如 4K) 的低解析度預覽代理檔
+ *
+ * 預覽播放代理檔以減少解碼像素，輸出仍讀取原始影片；
+ * 軌跡一律使用原始影片座標，預覽端依影格尺寸比例換算。
+ * 代理檔依影片雜湊存放在快取資料夾，同一支影片只產生一次。
+ */
+class ProxyMedia {
+public:
+    /**
+     * @brief 代理檔尺寸：短邊縮到 720，保持比例並取偶數
+     * @param source 原始影片尺寸
+     * @return 代理尺寸；不需要代理時回傳 source
+     */
+    static QSize proxySize(const QSize &source);
+
+    /**
+     * @brief 原始影片是否大到值得產生代理檔 (短邊大於 1080)
+     */
+    static bool needsProxy(const QSize &source);
+
+    /**
+     * @brief 尋找已產生的代理檔
+     * @param mediaHash 原始影片雜湊 (quickMediaHash)
+     * @return 代理檔路徑；不存在時為空字串
+     */
+    static QString find(const QString &mediaHash);
+
+    /**
+     * @brief 產生代理檔 (阻塞，請在背景執行緒呼叫)
+     * 優先使用 ffmpeg (保留音訊)，不可用時改用 OpenCV (無音訊 MJPG)
+     * @param source 原始影片路徑
+     * @param mediaHash 原始影片雜湊
+     * @param progress 進度回呼 (0~1，在背景執行緒呼叫)
+     * @param cancel 設為 true 時中止並刪除未完成的檔案
+     * @return 代理檔路徑；失敗或取消時為空字串
+     */
+    static QString generate(const QString &source, const QString &mediaHash,
+                            const std::function<void(double)> &progress,
+                            const std::atomic_bool &cancel);
+
+private:
+    static QString cacheDir();
+    static bool generateWithFfmpeg(const QString &source, const QString &out, const QSize &size,
+                                   double durationSec, const std::function<void(double)> &progress,
+                                   const std::atomic_bool &cancel);
+    static bool generateWithOpenCV(const QString &source, const QString &out, const QSize &size,
+                                   const std::function<void(double)> &progress,
+                                   const std::atomic_bool &cancel);
+};
+
+#endif // PROXYMEDIA_H
@@ -0,0 +1,219 @@
+#include "SegmentedExport.h"
+#include "ExportWriter.h"
+#include "PerfMetrics.h"
+#include "Trace.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 kSegmentVersion = 2;      ///< 片段格式版本 (輸出流程改變時遞增，使舊片段失效)
+const char kSegmentSuffix[] = ".mkv";       ///< 片段容器 (mkv 可放任何編碼，串接不需轉換)
+
+/**
+ * @brief 更新片段的修改時間，作為最近使用時間
+ */
+void touch(const QString &path)
+{
+    QFile f(path);
+    if (f.open(QIODevice::Append)) f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+} // namespace
+
+// -------------------------
+// 快取位置
+// -------------------------
+QString SegmentedExport::cacheDir(const QString &sourceId)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/segments";
+    if (!sourceId.isEmpty()) dir += "/" + sourceId;
+    QDir().mkpath(dir);
+    return dir;
+}
+
+// -------------------------
+// 影片識別與片段鍵值
+// -------------------------
+QString SegmentedExport::sourceId(const Job &job)
+{
+    // quickMediaHash 只取樣部分內容：加上路徑、大小與修改時間，改寫過的影片不會沿用舊片段
+    const QFileInfo info(job.source);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(job.mediaHash.toLatin1());
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()) + ','
+                 + QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString SegmentedExport::segmentKey(const Job &job, const ExportSegment &segment, const QString &profile)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(kSegmentVersion));
+    hash.addData(sourceId(job).toLatin1());
+    hash.addData(profile.toUtf8());
+    hash.addData(QByteArray::number(segment.first) + ',' + QByteArray::number(segment.count));
+
+    // 與 MultiFormatExport::cropView 相同的整數化
+    QVector<qint32> rois(segment.count * 4);
+    for (int i = 0; i < segment.count; ++i) {
+        const QRectF roi = job.path.roiAt(segment.first + i);
+        rois[i * 4 + 0] = qFloor(roi.x());
+        rois[i * 4 + 1] = qFloor(roi.y());
+        rois[i * 4 + 2] = qRound(roi.width());
+        rois[i * 4 + 3] = qRound(roi.height());
+    }
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(rois.constData()), rois.size() * sizeof(qint32)));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// -------------------------
+// 增量輸出
+// -------------------------
+bool SegmentedExport::run(const Job &job, const std::function<void(int, int)> &progress,
+                          const std::atomic_bool &cancel, Stats *stats, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (job.path.isEmpty() || job.sourceFrames <= 0 || job.mediaHash.isEmpty()) return fail("沒有裁切路徑");
+
+    const int first = qBound(0, job.range.first, job.sourceFrames - 1);
+    const int end = job.range.count >= 0 ? qMin(job.sourceFrames, first + job.range.count) : job.sourceFrames;
+    const QVector<ExportSegment> parts = splitExportSegments(job.keyframes, job.fps, first, end);
+    const QString dir = cacheDir(sourceId(job));
+
+    ExportWriter::Options segmentOptions;
+    segmentOptions.file      = dir + "/profile" + kSegmentSuffix;
+    segmentOptions.frameSize = job.outputSize;
+    segmentOptions.fps       = job.fps;
+    const QString profile = ExportWriter::videoProfile(segmentOptions);
+
+    cv::VideoCapture cap;
+    int nextFrame = -1;             ///< 解碼器目前位置 (連續的變動片段不需要跳轉)
+    const QSizeF maxRoi = job.path.maxRoiSize();
+    cv::Mat cropBuffer(qCeil(maxRoi.height()), qCeil(maxRoi.width()), CV_8UC3);
+    cv::Mat frame, outFrame(job.outputSize.height(), job.outputSize.width(), CV_8UC3);
+    const cv::Size outSize(job.outputSize.width(), job.outputSize.height());
+
+    Stats local;
+    Stats &counts = stats ? *stats : local;
+    QStringList files;
+    QString uncached;               ///< 提早到結尾的最後一段：只用於本次串接，完成後刪除
+    int done = 0;
+    const int total = end - first;
+    for (const ExportSegment &segment : parts) {
+        if (cancel) return fail("輸出任務已手動停止。");
+
+        const QString file = dir + "/" + segmentKey(job, segment, profile) + kSegmentSuffix;
+        files.append(file);
+
+        // 輸入沒有變動的片段直接沿用
+        if (QFile::exists(file)) {
+            touch(file);
+            ++counts.reused;
+            done += segment.count;
+            progress(done, total);
+            continue;
+        }
+
+        TRACE_SCOPE("export.segment", "export");
+        if (!cap.isOpened() && !cap.open(job.source.toStdString())) return fail("無法開啟影片！");
+        if (nextFrame != segment.first) cap.set(cv::CAP_PROP_POS_FRAMES, segment.first);
+
+        // 先寫暫存檔，完成後才改名，取消或失敗時不會留下不完整的片段
+        const QString part = file.chopped(int(sizeof(kSegmentSuffix)) - 1) + ".part" + kSegmentSuffix;
+        ExportWriter writer;
+        ExportWriter::Options options = segmentOptions;
+        options.file = part;
+        if (!writer.open(options)) return fail(writer.errorString());
+
+        bool ok = true, endOfFile = false;
+        int frames = 0;
+        for (; frames < segment.count && ok; ++frames) {
+            if (cancel) break;
+            if (!cap.read(frame)) {
+                endOfFile = true;
+                break;
+            }
+            const cv::Mat cropped = MultiFormatExport::cropView(frame, job.path.roiAt(segment.first + frames), cropBuffer);
+            cv::resize(cropped, outFrame, outSize);
+            ok = writer.write(outFrame);
+            if (++done % 15 == 0) progress(done, total);
+        }
+        nextFrame = segment.first + frames;
+
+        // 影格數回報偏多時最後一段會提早讀到結尾：本次照常串接，但不放入快取；
+        // 其他片段少了影格一律視為失敗，不完整的片段不能以完整範圍的鍵值沿用
+        const bool last = &segment == &parts.last();
+        const bool truncated = frames < segment.count;
+        const bool shortRead = truncated && !(last && endOfFile && frames > 0);
+
+        const bool written = writer.close() && ok && !shortRead && !cancel;
+        if (!written || (!truncated && !QFile::rename(part, file))) {
+            QFile::remove(part);
+            if (cancel) return fail("輸出任務已手動停止。");
+            if (ok && shortRead) return fail(QString("讀取影格失敗 (第 %1 格)").arg(segment.first + frames));
+            return fail(writer.errorString());
+        }
+        if (truncated) {
+            files.last() = part;
+            uncached = part;
+        }
+        ++counts.rendered;
+    }
+
+    // 串接 (不重新編碼) 並封裝原始音訊
+    ExportWriter::Options output;
+    output.file        = job.file;
+    output.audioSource = job.source;
+    output.startSec    = first / job.fps;
+    output.durationSec = job.range.count >= 0 ? total / job.fps : 0.0;
+    QString concatError;
+    const bool concatenated = ExportWriter::concat(files, output, &concatError);
+    if (!uncached.isEmpty()) QFile::remove(uncached);
+    if (!concatenated) return fail(concatError);
+
+    PerfMetrics::instance().count("export.segments.reused", counts.reused);
+    PerfMetrics::instance().count("export.segments.rendered", counts.rendered);
+    progress(total, total);
+    return true;
+}
+
+// -------------------------
+// 快取容量
+// -------------------------
+void SegmentedExport::prune(qint64 budgetBytes)
+{
+    QVector<QFileInfo> files;
+    qint64 totalBytes = 0;
+    QDirIterator it(cacheDir(), { QString("*") + kSegmentSuffix }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        // 中斷的輸出 (程式結束或當機) 留下的暫存片段：不會再被沿用，直接刪除
+        if (it.fileName().endsWith(QString(".part") + kSegmentSuffix)) {
+            QFile::remove(it.filePath());
+            continue;
+        }
+        files.append(it.fileInfo());
+        totalBytes += it.fileInfo().size();
+    }
+    if (totalBytes <= budgetBytes) return;
+
+    std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+    for (const QFileInfo &info : files) {
+        if (totalBytes <= budgetBytes) break;
+        if (QFile::remove(info.absoluteFilePath())) totalBytes -= info.size();
+    }
+}
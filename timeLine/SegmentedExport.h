@@ -0,0 +1,82 @@
+#ifndef SEGMENTEDEXPORT_H
+#define SEGMENTEDEXPORT_H
+
+#include <QByteArray>
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "CameraPathPlanner.h"
+#include "ExportSegments.h"
+#include "MultiFormatExport.h"
+
+/**
+ * @brief SegmentedExport
+ * 以片段快取做增量輸出
+ *
+ * 輸出範圍依原始影片的關鍵幀切成片段 (splitExportSegments，每段至少 kMinSegmentSec 秒)，
+ * 每段各自編碼成獨立的影像檔，鍵值是「片段範圍 + 逐幀裁切區域 + 編碼設定 + 影片識別」的雜湊。
+ * 影片識別是取樣雜湊加上路徑、大小與修改時間 (sourceId)，取樣雜湊碰撞或影片被改寫時不會沿用舊片段。
+ * 再次輸出時鍵值相同的片段直接沿用，只重新算裁切有變動的片段，
+ * 最後以 concat 串接 (不重新編碼) 並封裝原始音訊。
+ *
+ * 片段起點對齊關鍵幀，解碼時跳轉不需要先解出前一個 GOP。
+ * 快取存放在 CacheLocation/segments/<影片識別>，超過預算時刪除最久未用的片段。
+ */
+class SegmentedExport {
+public:
+    /**
+     * @brief 輸出工作
+     */
+    struct Job {
+        QString source;             ///< 原始影片
+        QString mediaHash;          ///< 原始影片雜湊
+        CameraPath path;            ///< 逐幀裁切區域
+        QSize outputSize;           ///< 輸出尺寸
+        double fps = 30.0;          ///< 原始影片影格率
+        int sourceFrames = 0;       ///< 原始影片影格數
+        ExportRange range;          ///< 輸出範圍
+        QVector<qint64> keyframes;  ///< 原始影片關鍵幀時間 (毫秒，可為空)
+        QString file;               ///< 輸出檔
+    };
+
+    /**
+     * @brief 輸出結果統計
+     */
+    struct Stats {
+        int reused = 0;             ///< 沿用的片段數
+        int rendered = 0;           ///< 重新輸出的片段數
+    };
+
+    /**
+     * @brief 片段的快取鍵值 (十六進位 SHA-1)
+     * 逐幀裁切區域以輸出實際使用的整數座標計算，浮點誤差不會造成重新輸出
+     */
+    static QString segmentKey(const Job &job, const ExportSegment &segment, const QString &profile);
+
+    /**
+     * @brief 執行增量輸出 (阻塞，請在背景執行緒呼叫)
+     * @param progress 進度回呼 (已完成影格數、總影格數)
+     * @param stats 統計 (可為 nullptr)
+     * @param error 失敗原因 (可為 nullptr)
+     * @return 是否成功
+     */
+    static bool run(const Job &job, const std::function<void(int, int)> &progress,
+                    const std::atomic_bool &cancel, Stats *stats = nullptr, QString *error = nullptr);
+
+    /**
+     * @brief 刪除中斷輸出留下的暫存片段，再刪除最久未使用的片段，直到快取總大小不超過預算
+     */
+    static void prune(qint64 budgetBytes);
+
+private:
+    /**
+     * @brief 影片識別 (十六進位 SHA-1)：取樣雜湊 + 絕對路徑 + 大小 + 修改時間
+     */
+    static QString sourceId(const Job &job);
+
+    static QString cacheDir(const QString &sourceId = QString());
+};
+
+#endif // SEGMENTEDEXPORT_H
@@ -0,0 +1,181 @@
+#include "Trace.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <memory>
+#include <vector>
+
+namespace trace {
+
+namespace detail {
+std::atomic_bool g_enabled{ false };
+}
+
+namespace {
+
+constexpr int kEventsPerThread = 1 << 16;   ///< 每個執行緒最多保留的事件數
+constexpr int kPooledBuffers = 4;           ///< 已結束執行緒歸還、留待重複使用的緩衝數上限
+
+struct Event {
+    const char *name;
+    const char *category;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+/**
+ * @brief 單一執行緒的事件緩衝：只有擁有者寫入，count 以 release 發布給輸出端
+ * 執行緒結束時事件搬到剛好大小的 retired，固定大小的 events 歸還緩衝池
+ */
+struct ThreadBuffer {
+    std::unique_ptr<Event[]> events;        ///< 執行中的固定大小緩衝 (kEventsPerThread)
+    std::vector<Event> retired;             ///< 執行緒結束後保留的事件
+    std::atomic<int> count{ 0 };
+    std::atomic<qint64> dropped{ 0 };
+    int tid = 0;
+    QString threadName;
+};
+
+QElapsedTimer g_clock;
+QMutex g_registryMutex;                             ///< 只在執行緒第一次記錄與結束時使用
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers; ///< 各執行緒的事件 (輸出前都要保留)
+std::vector<std::unique_ptr<Event[]>> g_pool;       ///< 可重複使用的固定大小緩衝 (最多 kPooledBuffers 個)
+
+/**
+ * @brief 執行緒結束：事件搬到剛好大小的陣列，固定緩衝歸還緩衝池 (池滿則釋放)
+ * 執行緒池的短命執行緒不會各自留下 2MB 緩衝
+ */
+void retire(ThreadBuffer *buffer)
+{
+    QMutexLocker lock(&g_registryMutex);
+    const int count = buffer->count.load(std::memory_order_acquire);
+    buffer->retired.assign(buffer->events.get(), buffer->events.get() + count);
+    if (static_cast<int>(g_pool.size()) < kPooledBuffers) g_pool.push_back(std::move(buffer->events));
+    buffer->events.reset();
+}
+
+/**
+ * @brief thread_local 解構即為執行緒結束
+ */
+struct ThreadSlot {
+    ThreadBuffer *buffer = nullptr;
+    ~ThreadSlot() { if (buffer) retire(buffer); }
+};
+
+ThreadBuffer *threadBuffer()
+{
+    thread_local ThreadSlot slot;
+    if (slot.buffer) return slot.buffer;
+
+    auto created = std::make_unique<ThreadBuffer>();
+    QThread *thread = QThread::currentThread();
+    created->threadName = thread && !thread->objectName().isEmpty() ? thread->objectName() : QString();
+
+    QMutexLocker lock(&g_registryMutex);
+    if (!g_pool.empty()) {
+        created->events = std::move(g_pool.back());
+        g_pool.pop_back();
+    } else {
+        created->events.reset(new Event[kEventsPerThread]);
+    }
+    created->tid = static_cast<int>(g_buffers.size()) + 1;
+    if (created->threadName.isEmpty()) created->threadName = QString("thread-%1").arg(created->tid);
+    slot.buffer = created.get();
+    g_buffers.push_back(std::move(created));
+    return slot.buffer;
+}
+
+/**
+ * @brief JSON 字串跳脫 (名稱都是程式內的常值，只需處理引號與反斜線)
+ */
+QByteArray jsonString(const QByteArray &s)
+{
+    QByteArray out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace
+
+void start()
+{
+    g_clock.start();
+    detail::g_enabled.store(true, std::memory_order_release);
+}
+
+qint64 now()
+{
+    return enabled() ? g_clock.nsecsElapsed() : 0;
+}
+
+void complete(const char *name, const char *category, qint64 startNs)
+{
+    if (!enabled()) return;
+
+    const qint64 end = g_clock.nsecsElapsed();
+    ThreadBuffer *buffer = threadBuffer();
+    const int index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= kEventsPerThread) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = { name, category, startNs, end - startNs };
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+bool write(const QString &path)
+{
+    detail::g_enabled.store(false, std::memory_order_release);
+
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+
+    QMutexLocker lock(&g_registryMutex);
+    QByteArray out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+
+    for (const auto &buffer : g_buffers) {
+        const QByteArray tid = QByteArray::number(buffer->tid);
+
+        // 執行緒名稱 (metadata event)
+        separator();
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+               + ",\"args\":{\"name\":" + jsonString(buffer->threadName.toUtf8()) + "}}";
+
+        // 已結束的執行緒只剩 retired (在鎖內搬移，不會與 retire() 交錯)
+        const int count = buffer->count.load(std::memory_order_acquire);
+        const Event *events = buffer->events ? buffer->events.get() : buffer->retired.data();
+        for (int i = 0; i < count; ++i) {
+            const Event &e = events[i];
+            separator();
+            out += "{\"name\":" + jsonString(e.name) + ",\"cat\":" + jsonString(e.category)
+                   + ",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid
+                   + ",\"ts\":" + QByteArray::number(e.startNs / 1000.0, 'f', 3)
+                   + ",\"dur\":" + QByteArray::number(e.durationNs / 1000.0, 'f', 3) + "}";
+        }
+
+        if (const qint64 dropped = buffer->dropped.load(std::memory_order_relaxed)) {
+            separator();
+            out += "{\"name\":\"trace_dropped\",\"ph\":\"C\",\"pid\":1,\"tid\":" + tid
+                   + ",\"ts\":0,\"args\":{\"events\":" + QByteArray::number(dropped) + "}}";
+        }
+    }
+
+    out += "\n]}\n";
+    return f.write(out) == out.size();
+}
+
+} // namespace trace
@@ -0,0 +1,78 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief Chrome trace-event 追蹤 (Perfetto / chrome://tracing 可直接開啟)
+ *
+ * 每個執行緒第一次記錄時取得自己的固定大小緩衝 (優先重複使用已結束執行緒歸還的)，之後寫入只有單一寫者，
+ * 不需要鎖；緩衝滿了就丟棄並計數，不會在熱路徑上配置記憶體。
+ * 未啟用時 TRACE_SCOPE 只是一次 relaxed atomic 讀取。
+ *
+ * 事件名稱與分類必須是字串常值 (只存指標)。
+ *
+ * 用法：
+ *   TRACE_SCOPE("paint", "ui");               // 作用域
+ *   qint64 t0 = trace::now();  ...;  trace::complete("decode", "export", t0);
+ */
+namespace trace {
+
+namespace detail {
+extern std::atomic_bool g_enabled;
+}
+
+/**
+ * @brief 是否正在追蹤
+ */
+inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+
+/**
+ * @brief 開始追蹤 (程式啟動時呼叫一次)
+ */
+void start();
+
+/**
+ * @brief 自追蹤起點的時間 (奈秒)；未啟用時回傳 0
+ */
+qint64 now();
+
+/**
+ * @brief 記錄一段已完成的事件 (ph = "X")
+ * @param startNs trace::now() 取得的開始時間
+ */
+void complete(const char *name, const char *category, qint64 startNs);
+
+/**
+ * @brief 停止追蹤並寫成 Chrome trace JSON
+ * @return 是否寫入成功
+ */
+bool write(const QString &path);
+
+/**
+ * @brief 作用域事件
+ */
+class Scope {
+public:
+    Scope(const char *name, const char *category)
+        : m_name(enabled() ? name : nullptr), m_category(category), m_start(m_name ? now() : 0) {}
+    ~Scope() { if (m_name) complete(m_name, m_category, m_start); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_start;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, category) trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name, category)
+
+#endif // TRACE_H
@@ -0,0 +1,151 @@
+#include "TrackCorrection.h"
+#include "PersonDetector.h"
+#include "Trace.h"
+#include <QLineF>
+#include <algorithm>
+
+namespace {
+
+constexpr int kCandidates = 10;             ///< 每格最多比對的人物數
+constexpr double kMatchIou = 0.3;           ///< 與前一格配對的最低 IoU
+constexpr double kMatchDistance = 0.5;      ///< IoU 不足時的中心距離上限 (人物框高度比例)
+constexpr double kConvergeDistance = 0.15;  ///< 與原軌跡一致：中心距離上限 (人物框高度比例)
+constexpr double kConvergeSize = 0.25;      ///< 與原軌跡一致：框高相對差上限 (原軌跡有框大小時)
+constexpr double kConvergeSec = 0.5;        ///< 連續一致多久視為收斂 (秒)
+constexpr double kMaxLostSec = 1.0;         ///< 連續跟丟多久就停止 (秒)
+
+double iou(const QRectF &a, const QRectF &b)
+{
+    const QRectF overlap = a.intersected(b);
+    if (overlap.isEmpty()) return 0;
+    const double inter = overlap.width() * overlap.height();
+    return inter / (a.width() * a.height() + b.width() * b.height() - inter);
+}
+
+double distance(const QPointF &a, const QPointF &b)
+{
+    return QLineF(a, b).length();
+}
+
+DataPoint toPoint(const QRectF &box, double sec)
+{
+    return { sec, box.center().x(), box.center().y(), box.width(), box.height() };
+}
+
+/**
+ * @brief 原軌跡中最接近 sec 的數據點 (tolerance 秒以內)；沒有時回傳 nullptr
+ * 舊軌跡可能有空缺 (偵測不到人的影格不寫入)，空缺處不內插
+ */
+const DataPoint *pointNear(const QVector<DataPoint> &points, double sec, double tolerance)
+{
+    auto it = std::lower_bound(points.begin(), points.end(), sec - tolerance,
+                               [](const DataPoint &d, double t) { return d.time < t; });
+    const DataPoint *best = nullptr;
+    for (; it != points.end() && it->time <= sec + tolerance; ++it) {
+        if (!best || qAbs(it->time - sec) < qAbs(best->time - sec)) best = &*it;
+    }
+    return best;
+}
+
+/**
+ * @brief 新人物框是否與原軌跡一致
+ */
+bool agrees(const DataPoint *old, const QRectF &box)
+{
+    if (!old) return false;
+    const double h = qMax(1.0, box.height());
+    if (distance(QPointF(old->x, old->y), box.center()) > kConvergeDistance * h) return false;
+    return old->h <= 0 || qAbs(old->h - box.height()) <= kConvergeSize * h;
+}
+
+} // namespace
+
+// -------------------------
+// 重新追蹤
+// -------------------------
+bool TrackCorrection::run(const Job &job, const std::function<void(int)> &progress,
+                          const std::atomic_bool &cancel, Result *result, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (!result || job.fps <= 0) return fail("影格率未知");
+
+    PersonDetector detector;
+    if (!detector.load(job.model, error)) return false;
+
+    cv::VideoCapture cap(job.source.toStdString());
+    if (!cap.isOpened()) return fail("無法開啟影片！");
+    if (job.startFrame > 0) cap.set(cv::CAP_PROP_POS_FRAMES, job.startFrame);
+
+    cv::Mat frame;
+    if (!cap.read(frame)) return fail("無法讀取校正影格");
+
+    // 種子：包含點擊位置的人物框優先，其次中心最近
+    QRectF box;
+    bool seeded = false, seedInside = false;
+    double seedDistance = 0;
+    for (const PersonDetector::Detection &d : detector.detect(frame, kCandidates)) {
+        const bool inside = d.box.contains(job.seed);
+        const double dist = distance(d.box.center(), job.seed);
+        if (!inside && dist > kMatchDistance * d.box.height()) continue;
+        if (!seeded || (inside && !seedInside) || (inside == seedInside && dist < seedDistance)) {
+            box = d.box;
+            seeded = true;
+            seedInside = inside;
+            seedDistance = dist;
+        }
+    }
+    if (!seeded) return fail("點擊位置附近沒有偵測到人物");
+
+    const double frameSec = 1.0 / job.fps;
+    const int convergeFrames = qMax(3, qRound(kConvergeSec * job.fps));
+    const int maxLost = qMax(1, qRound(kMaxLostSec * job.fps));
+
+    Result out;
+    out.span.append(toPoint(box, job.startFrame * frameSec));
+    int agreeRun = agrees(pointNear(job.trajectory, job.startFrame * frameSec, frameSec), box) ? 1 : 0;
+    int lost = 0, done = 1;
+
+    for (int f = job.startFrame + 1; agreeRun < convergeFrames; ++f) {
+        if (cancel) return fail("校正已手動停止。");
+        if (!cap.read(frame)) break;    // 影片結尾
+
+        TRACE_SCOPE("correction.frame", "tracker");
+        const QVector<PersonDetector::Detection> candidates = detector.detect(frame, kCandidates);
+        if (++done % 15 == 0) progress(done);
+
+        // 與前一格配對：IoU 最大者，重疊不足時取中心最近者
+        const QRectF *match = nullptr;
+        double bestIou = kMatchIou;
+        for (const PersonDetector::Detection &c : candidates) {
+            const double v = iou(box, c.box);
+            if (v >= bestIou) { bestIou = v; match = &c.box; }
+        }
+        if (!match) {
+            double bestDistance = kMatchDistance * box.height();
+            for (const PersonDetector::Detection &c : candidates) {
+                const double dist = distance(box.center(), c.box.center());
+                if (dist <= bestDistance) { bestDistance = dist; match = &c.box; }
+            }
+        }
+
+        // 跟丟的影格不寫入 (與追蹤腳本相同)，連續太久就停止
+        if (!match) {
+            if (++lost >= maxLost) break;
+            continue;
+        }
+        lost = 0;
+        box = *match;
+
+        const double sec = f * frameSec;
+        out.span.append(toPoint(box, sec));
+        agreeRun = agrees(pointNear(job.trajectory, sec, frameSec), box) ? agreeRun + 1 : 0;
+    }
+
+    out.converged = agreeRun >= convergeFrames;
+    progress(done);
+    *result = out;
+    return true;
+}
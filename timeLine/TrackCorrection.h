@@ -0,0 +1,57 @@
+#ifndef TRACKCORRECTION_H
+#define TRACKCORRECTION_H
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "Trajectory.h"
+
+/**
+ * @brief TrackCorrection
+ * 點擊校正：追蹤鎖定到錯誤的人時，從點擊的影格重新播種並只往後重新追蹤受影響的區段
+ *
+ * 1. 在校正影格偵測所有人物，選出包含點擊位置的人物框作為種子
+ * 2. 往後逐格偵測，以 IoU (不足時以中心距離) 與前一格的人物框配對，只跟隨同一個人
+ * 3. 新人物框與原軌跡連續 kConvergeSec 秒一致時視為已收斂，停止追蹤
+ *
+ * 結果只是原始影片座標的區段，由呼叫端以 spliceTrajectory() 併回軌跡；
+ * 一直沒有收斂時追到影片結尾，連續跟丟超過 kMaxLostSec 秒時停在最後一個配對的影格。
+ */
+class TrackCorrection {
+public:
+    /**
+     * @brief 校正工作
+     */
+    struct Job {
+        QString source;                 ///< 原始影片 (座標與軌跡相同)
+        QString model;                  ///< YOLOv5 ONNX 模型
+        double fps = 30.0;              ///< 原始影片影格率
+        int startFrame = 0;             ///< 校正影格 (點擊時顯示的影格)
+        QPointF seed;                   ///< 點擊位置 (原始影片座標)
+        QVector<DataPoint> trajectory;  ///< 目前軌跡 (判斷何時收斂)
+    };
+
+    /**
+     * @brief 校正結果
+     */
+    struct Result {
+        QVector<DataPoint> span;        ///< 重新追蹤的區段 (依時間遞增)
+        bool converged = false;         ///< 是否已回到原軌跡 (否則追到結尾或跟丟)
+    };
+
+    /**
+     * @brief 重新追蹤 (阻塞，請在背景執行緒呼叫)
+     * @param job 校正工作
+     * @param progress 進度回呼 (已處理的影格數，在背景執行緒呼叫)
+     * @param cancel 設為 true 時中止
+     * @param result 輸出結果
+     * @param error 失敗原因 (可為 nullptr)
+     * @return 是否成功 (點擊位置沒有人物、取消或無法開啟影片時失敗)
+     */
+    static bool run(const Job &job, const std::function<void(int)> &progress,
+                    const std::atomic_bool &cancel, Result *result, QString *error = nullptr);
+};
+
+#endif // TRACKCORRECTION_H
@@ -0,0 +1,289 @@
+#include "VideoFrameMat.h"
+#include "YuvCoefficients.h"
+#include <cstring>
+
+namespace {
+
+using PF = QVideoFrameFormat::PixelFormat;
+
+/**
+ * @brief 可以直接映射成 cv::Mat 的格式
+ */
+bool isMappable(PF format)
+{
+    switch (format) {
+    case PF::Format_BGRA8888: case PF::Format_BGRA8888_Premultiplied: case PF::Format_BGRX8888:
+    case PF::Format_RGBA8888: case PF::Format_RGBX8888:
+    case PF::Format_ARGB8888: case PF::Format_ARGB8888_Premultiplied: case PF::Format_XRGB8888:
+    case PF::Format_ABGR8888: case PF::Format_XBGR8888:
+    case PF::Format_NV12: case PF::Format_NV21:
+    case PF::Format_YUV420P: case PF::Format_YV12:
+    case PF::Format_UYVY: case PF::Format_YUYV:
+    case PF::Format_Y8: case PF::Format_Y16:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isBgraOrder(PF format)
+{
+    return format == PF::Format_BGRA8888 || format == PF::Format_BGRA8888_Premultiplied
+        || format == PF::Format_BGRX8888;
+}
+
+bool isRgbaOrder(PF format)
+{
+    return format == PF::Format_RGBA8888 || format == PF::Format_RGBX8888;
+}
+
+bool isArgbOrder(PF format)
+{
+    return format == PF::Format_ARGB8888 || format == PF::Format_ARGB8888_Premultiplied
+        || format == PF::Format_XRGB8888;
+}
+
+bool isAbgrOrder(PF format)
+{
+    return format == PF::Format_ABGR8888 || format == PF::Format_XBGR8888;
+}
+
+bool isYuv(PF format)
+{
+    return format == PF::Format_NV12 || format == PF::Format_NV21
+        || format == PF::Format_YUV420P || format == PF::Format_YV12
+        || format == PF::Format_UYVY || format == PF::Format_YUYV;
+}
+
+/**
+ * @brief YUV 取樣位置：第 x 個像素的 Y 在 y[x * yStep + yOffset]，U / V 在 u[(x / 2) * cStep + uOffset]
+ */
+struct YuvLayout {
+    const uchar *y, *u, *v;
+    size_t yStride, uStride, vStride;
+    int yStep, yOffset;
+    int cStep, uOffset, vOffset;
+    int cRowShift;      ///< 4:2:0 色度列數減半為 1，4:2:2 為 0
+};
+
+YuvLayout yuvLayout(PF format, const cv::Mat &p0, const cv::Mat &p1, const cv::Mat &p2)
+{
+    switch (format) {
+    case PF::Format_NV12:
+        return { p0.data, p1.data, p1.data, p0.step, p1.step, p1.step, 1, 0, 2, 0, 1, 1 };
+    case PF::Format_NV21:
+        return { p0.data, p1.data, p1.data, p0.step, p1.step, p1.step, 1, 0, 2, 1, 0, 1 };
+    case PF::Format_YUV420P:
+        return { p0.data, p1.data, p2.data, p0.step, p1.step, p2.step, 1, 0, 1, 0, 0, 1 };
+    case PF::Format_YV12:
+        return { p0.data, p2.data, p1.data, p0.step, p2.step, p1.step, 1, 0, 1, 0, 0, 1 };
+    case PF::Format_YUYV:   // Y0 U Y1 V
+        return { p0.data, p0.data, p0.data, p0.step, p0.step, p0.step, 2, 0, 4, 1, 3, 0 };
+    default:                // UYVY：U Y0 V Y1
+        return { p0.data, p0.data, p0.data, p0.step, p0.step, p0.step, 2, 1, 4, 0, 2, 0 };
+    }
+}
+
+/**
+ * @brief 依係數轉成 BGR (與預覽取樣相同的 8.8 定點公式，逐列平行)
+ */
+void convertYuv(const YuvLayout &l, const YuvCoefficients &k, cv::Mat &dst)
+{
+    cv::parallel_for_(cv::Range(0, dst.rows), [&](const cv::Range &range) {
+        for (int r = range.start; r < range.end; ++r) {
+            const uchar *yRow = l.y + r * l.yStride;
+            const uchar *uRow = l.u + (r >> l.cRowShift) * l.uStride;
+            const uchar *vRow = l.v + (r >> l.cRowShift) * l.vStride;
+            uchar *out = dst.ptr<uchar>(r);
+            for (int x = 0; x < dst.cols; ++x, out += 3) {
+                const int c = (yRow[x * l.yStep + l.yOffset] - k.yOffset) * k.y;
+                const int d = uRow[(x >> 1) * l.cStep + l.uOffset] - 128;
+                const int e = vRow[(x >> 1) * l.cStep + l.vOffset] - 128;
+                out[0] = cv::saturate_cast<uchar>((c + k.bu * d + 128) >> 8);
+                out[1] = cv::saturate_cast<uchar>((c - k.gu * d - k.gv * e + 128) >> 8);
+                out[2] = cv::saturate_cast<uchar>((c + k.rv * e + 128) >> 8);
+            }
+        }
+    });
+}
+
+} // namespace
+
+VideoFrameMat::VideoFrameMat(const QVideoFrame &frame)
+    : m_frame(frame), m_format(frame.pixelFormat())
+{
+    if (!m_frame.isValid()) return;
+
+    if (isMappable(m_format) && m_frame.map(QVideoFrame::ReadOnly)) {
+        m_mapped = true;
+        return;
+    }
+
+    // 硬體材質或少見格式：由 Qt 轉換一次 (RGB32 在記憶體中為 B, G, R, X)
+    m_image = m_frame.toImage().convertToFormat(QImage::Format_RGB32);
+    m_format = PF::Format_BGRX8888;
+}
+
+VideoFrameMat::~VideoFrameMat()
+{
+    if (m_mapped) m_frame.unmap();
+}
+
+// -------------------------
+// 零複製 view
+// -------------------------
+cv::Mat VideoFrameMat::plane(int index) const
+{
+    if (!m_image.isNull()) {
+        if (index != 0) return cv::Mat();
+        return cv::Mat(m_image.height(), m_image.width(), CV_8UC4,
+                       const_cast<uchar *>(m_image.constBits()), size_t(m_image.bytesPerLine()));
+    }
+    if (!m_mapped || index >= m_frame.planeCount()) return cv::Mat();
+
+    const int w = m_frame.width(), h = m_frame.height();
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;   // 4:2:0 色度平面
+    int rows = h, cols = w, type = CV_8UC1;
+    switch (m_format) {
+    case PF::Format_NV12: case PF::Format_NV21:
+        if (index == 1) { rows = ch; cols = cw; type = CV_8UC2; }
+        break;
+    case PF::Format_YUV420P: case PF::Format_YV12:
+        if (index > 0) { rows = ch; cols = cw; }
+        break;
+    case PF::Format_UYVY: case PF::Format_YUYV:
+        type = CV_8UC2;
+        break;
+    case PF::Format_Y8:
+        break;
+    case PF::Format_Y16:
+        type = CV_16UC1;
+        break;
+    default:
+        type = CV_8UC4;     // 四通道 RGB 類格式
+        break;
+    }
+
+    // 映射的記憶體為唯讀，view 不可寫入
+    return cv::Mat(rows, cols, type, const_cast<uchar *>(m_frame.bits(index)),
+                   size_t(m_frame.bytesPerLine(index)));
+}
+
+cv::Mat VideoFrameMat::bgra() const
+{
+    return isBgraOrder(m_format) ? plane(0) : cv::Mat();
+}
+
+// -------------------------
+// 灰階
+// -------------------------
+cv::Mat VideoFrameMat::gray(cv::Mat &scratch) const
+{
+    if (!isValid()) return cv::Mat();
+
+    switch (m_format) {
+    case PF::Format_NV12: case PF::Format_NV21:
+    case PF::Format_YUV420P: case PF::Format_YV12:
+    case PF::Format_Y8:
+        return plane(0);    // 亮度平面即灰階
+    case PF::Format_UYVY:
+        cv::extractChannel(plane(0), scratch, 1);
+        return scratch;
+    case PF::Format_YUYV:
+        cv::extractChannel(plane(0), scratch, 0);
+        return scratch;
+    case PF::Format_Y16:
+        plane(0).convertTo(scratch, CV_8U, 1.0 / 256.0);
+        return scratch;
+    default:
+        break;
+    }
+
+    if (isBgraOrder(m_format)) cv::cvtColor(plane(0), scratch, cv::COLOR_BGRA2GRAY);
+    else if (isRgbaOrder(m_format)) cv::cvtColor(plane(0), scratch, cv::COLOR_RGBA2GRAY);
+    else if (toBgr(m_packed)) cv::cvtColor(m_packed, scratch, cv::COLOR_BGR2GRAY);
+    else return cv::Mat();
+    return scratch;
+}
+
+// -------------------------
+// BGR (一次轉換)
+// -------------------------
+bool VideoFrameMat::toBgr(cv::Mat &dst) const
+{
+    if (!isValid()) return false;
+
+    const cv::Mat p0 = plane(0);
+
+    // OpenCV 的 YUV → BGR 固定為 BT.601 limited range：其他色彩空間或 full range 依影格格式的係數轉換
+    if (m_mapped && isYuv(m_format)) {
+        const YuvCoefficients k = yuvCoefficients(m_frame.surfaceFormat());
+        if (!k.bt601Limited) {
+            dst.create(m_frame.height(), m_frame.width(), CV_8UC3);
+            convertYuv(yuvLayout(m_format, p0, plane(1), plane(2)), k, dst);
+            return true;
+        }
+    }
+
+    switch (m_format) {
+    case PF::Format_NV12:
+        cv::cvtColorTwoPlane(p0, plane(1), dst, cv::COLOR_YUV2BGR_NV12);
+        return true;
+    case PF::Format_NV21:
+        cv::cvtColorTwoPlane(p0, plane(1), dst, cv::COLOR_YUV2BGR_NV21);
+        return true;
+    case PF::Format_YUV420P: case PF::Format_YV12: {
+        const int w = m_frame.width(), h = m_frame.height();
+        if ((w | h) & 1) return false;
+        const cv::Mat p1 = plane(1), p2 = plane(2);
+
+        // 三個平面在記憶體中緊密相連時直接當成一張 I420 影像，否則重組一次
+        const uchar *y = p0.data;
+        cv::Mat packed;
+        if (p0.step == size_t(w) && p1.step == size_t(w / 2) && p2.step == size_t(w / 2)
+            && p1.data == y + w * h && p2.data == p1.data + (w / 2) * (h / 2)) {
+            packed = cv::Mat(h * 3 / 2, w, CV_8UC1, const_cast<uchar *>(y));
+        } else {
+            m_packed.create(h * 3 / 2, w, CV_8UC1);
+            uchar *out = m_packed.data;
+            for (int r = 0; r < h; ++r, out += w) std::memcpy(out, p0.ptr(r), w);
+            for (const cv::Mat *chroma : { &p1, &p2 }) {
+                for (int r = 0; r < h / 2; ++r, out += w / 2) std::memcpy(out, chroma->ptr(r), w / 2);
+            }
+            packed = m_packed;
+        }
+        cv::cvtColor(packed, dst, m_format == PF::Format_YV12 ? cv::COLOR_YUV2BGR_YV12 : cv::COLOR_YUV2BGR_I420);
+        return true;
+    }
+    case PF::Format_UYVY:
+        cv::cvtColor(p0, dst, cv::COLOR_YUV2BGR_UYVY);
+        return true;
+    case PF::Format_YUYV:
+        cv::cvtColor(p0, dst, cv::COLOR_YUV2BGR_YUY2);
+        return true;
+    case PF::Format_Y8:
+        cv::cvtColor(p0, dst, cv::COLOR_GRAY2BGR);
+        return true;
+    case PF::Format_Y16:
+        p0.convertTo(m_packed, CV_8U, 1.0 / 256.0);
+        cv::cvtColor(m_packed, dst, cv::COLOR_GRAY2BGR);
+        return true;
+    default:
+        break;
+    }
+
+    if (isBgraOrder(m_format)) {
+        cv::cvtColor(p0, dst, cv::COLOR_BGRA2BGR);
+    } else if (isRgbaOrder(m_format)) {
+        cv::cvtColor(p0, dst, cv::COLOR_RGBA2BGR);
+    } else if (isArgbOrder(m_format) || isAbgrOrder(m_format)) {
+        // A R G B / A B G R：跳過 alpha 重排通道
+        dst.create(p0.rows, p0.cols, CV_8UC3);
+        const int argb[] = { 3, 0, 2, 1, 1, 2 };
+        const int abgr[] = { 1, 0, 2, 1, 3, 2 };
+        cv::mixChannels(&p0, 1, &dst, 1, isArgbOrder(m_format) ? argb : abgr, 3);
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef VIDEOFRAMEMAT_H
+#define VIDEOFRAMEMAT_H
+
+#include <QImage>
+#include <QSize>
+#include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief VideoFrameMat
+ * 把播放器已解碼的 QVideoFrame 映射成 cv::Mat，分析時不必再用 cv::VideoCapture 解碼一次
+ *
+ * 建構時以唯讀映射影格，解構時解除映射；取得的 view 只在本物件存在期間有效，且不可寫入。
+ *
+ * - plane() / gray()：YUV (NV12/NV21/I420/YV12)、Y8 的亮度平面與 BGRA/BGRX 四通道影像
+ *   直接包住映射記憶體，不複製像素
+ * - toBgr()：需要 BGR 三通道時只做一次色彩轉換，寫進呼叫端重複使用的緩衝
+ * - 其他格式 (例如硬體材質) 由 QVideoFrame::toImage() 轉換一次後再包成 view
+ */
+class VideoFrameMat {
+public:
+    explicit VideoFrameMat(const QVideoFrame &frame);
+    ~VideoFrameMat();
+
+    VideoFrameMat(const VideoFrameMat &) = delete;
+    VideoFrameMat &operator=(const VideoFrameMat &) = delete;
+
+    /**
+     * @brief 是否可以取得像素 (映射成功，或已轉換成備用影像)
+     */
+    bool isValid() const { return m_mapped || !m_image.isNull(); }
+
+    QVideoFrameFormat::PixelFormat pixelFormat() const { return m_format; }
+    QSize size() const { return m_frame.size(); }
+
+    /**
+     * @brief 影格顯示時間 (微秒)
+     */
+    qint64 startTime() const { return m_frame.startTime(); }
+
+    /**
+     * @brief 第 index 個平面的原始排列 view (零複製)
+     * 例如 NV12 的 plane(0) 為 CV_8UC1 亮度、plane(1) 為 CV_8UC2 交錯色度；不支援時回傳空 Mat
+     */
+    cv::Mat plane(int index) const;
+
+    /**
+     * @brief 四通道 BGRA view (零複製)：只有 BGRA8888 / BGRX8888 與備用影像可用，其他格式回傳空 Mat
+     */
+    cv::Mat bgra() const;
+
+    /**
+     * @brief 灰階 (亮度) 影像
+     * @param scratch 需要轉換時的輸出緩衝 (尺寸不變時重複使用)
+     * @return YUV / Y8 格式為亮度平面 view (零複製)；其他格式為轉換到 scratch 的結果
+     */
+    cv::Mat gray(cv::Mat &scratch) const;
+
+    /**
+     * @brief 轉成 BGR 三通道 (一次色彩轉換)
+     * YUV 依影格格式的色彩空間與範圍選擇轉換矩陣 (與預覽相同)；BT.601 limited range 交給 OpenCV
+     * @param dst 輸出 (尺寸不變時重複使用，不重新配置)
+     * @return 是否成功
+     */
+    bool toBgr(cv::Mat &dst) const;
+
+private:
+    QVideoFrame m_frame;                        ///< 共享參考，不複製像素
+    QVideoFrameFormat::PixelFormat m_format;    ///< 映射時的像素格式 (備用影像時為 BGRX8888)
+    bool m_mapped = false;
+    QImage m_image;                             ///< 無法直接映射的格式：toImage() 轉換一次的結果
+    mutable cv::Mat m_packed;                   ///< I420 / YV12 平面不連續時的重組緩衝
+};
+
+#endif // VIDEOFRAMEMAT_H
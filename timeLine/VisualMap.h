@@ -3,11 +3,32 @@
 
 #include <QWidget>
 #include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QLineF>
+#include <QPixmap>
+#include <QImage>
+#include <QBitArray>
+#include <QMap>
+#include <QVector>
+#include <QtMath>
+#include <iterator>
+#include <limits>
+#include "PerfMetrics.h"
+#include "Trace.h"
 
 /**
  * @brief VisualMap
  * 用於顯示影片追蹤位置的可視化地圖
  * 顯示紅色十字與圓點，對應當前座標
+ *
+ * 靜態圖層 (背景、邊框、中心虛線、標題) 快取在 QPixmap，只在尺寸改變時重建；
+ * 位置更新時只重繪新舊標記周圍的髒矩形。
+ * 開啟歷史模式後，另外累積軌跡線與佔據熱圖，兩者都以增量方式更新，
+ * 顯示整段歷程的成本與只畫目前一點相同。
+ *
+ * 歷史依軌跡時間累積 (每 kHistoryStepMs 一格)：暫停、倒轉或重複更新同一時間都不會重複計數，
+ * 軌跡線也依時間順序連接。保留的軌跡點超過 kMaxHistory 時間隔加倍 (抽稀)，記憶體有上限。
  */
 class VisualMap : public QWidget {
     Q_OBJECT
@@ -22,87 +43,334 @@ public:
         m_currY = 0;                  ///< 初始 Y 座標
         setMinimumHeight(250);        ///< 設定最小高度
 
-        // 設定背景顏色為白色
-        QPalette pal = palette();
-        pal.setColor(QPalette::Window, Qt::white);
-        setPalette(pal);
-        setAutoFillBackground(true);
+        // 背景由快取圖層完整覆蓋，不需要 Qt 先清背景
+        setAttribute(Qt::WA_OpaquePaintEvent);
+
+        m_heat = QImage(kHeatW, kHeatH, QImage::Format_ARGB32_Premultiplied);
+        clearHistory();
     }
 
     /**
      * @brief 更新當前座標
      * @param x 當前 X 座標
      * @param y 當前 Y 座標
-     * 會觸發 repaint
+     * @param sec 軌跡時間 (秒)，歷史依此去重；負值表示不加入歷史
+     * 只重繪新舊標記 (與新增的軌跡、熱圖格) 所在的髒矩形
      */
-    void updatePosition(double x, double y) {
+    void updatePosition(double x, double y, double sec = -1) {
+        QRect dirty = markerRect(m_currX, m_currY);
+
+        if (m_historyEnabled && sec >= 0) {
+            dirty |= appendHistory(x, y, static_cast<qint64>(sec * 1000.0 / kHistoryStepMs));
+        }
+
         m_currX = x;
         m_currY = y;
-        update(); // 觸發 paintEvent
+        dirty |= markerRect(m_currX, m_currY);
+        update(dirty); // 只觸發髒矩形的 paintEvent
+    }
+
+    /**
+     * @brief 開啟或關閉軌跡與熱圖模式
+     */
+    void setHistoryEnabled(bool enabled) {
+        if (m_historyEnabled == enabled) return;
+        m_historyEnabled = enabled;
+        update();
+    }
+
+    bool historyEnabled() const { return m_historyEnabled; }
+
+    /**
+     * @brief 設定原始影片尺寸 (座標範圍與地圖比例)
+     * 直式或 4K 影片都依實際尺寸映射
+     */
+    void setSourceSize(const QSize &size) {
+        if (size.isEmpty() || size == m_sourceSize) return;   // 讀取失敗的 0x0 不採用
+        m_sourceSize = size;
+        clearHistory();
+        rebuildLayers();
+        update();
+    }
+
+    /**
+     * @brief 原始影片座標映射到地圖座標 (超出影片範圍時貼齊邊界)
+     * @param x, y 原始影片座標
+     * @param sourceSize 原始影片尺寸
+     * @param mapRect 地圖區域 (Widget 座標)
+     */
+    static QPoint mapPoint(double x, double y, const QSize &sourceSize, const QRect &mapRect) {
+        const double srcW = sourceSize.width(), srcH = sourceSize.height();
+        double normX = qBound(0.0, x, srcW);
+        double normY = qBound(0.0, y, srcH);
+        return QPoint(mapRect.left() + static_cast<int>(normX / srcW * mapRect.width()),
+                      mapRect.top() + static_cast<int>(normY / srcH * mapRect.height()));
+    }
+
+    /**
+     * @brief 清除累積的軌跡與熱圖 (載入新影片時呼叫)
+     */
+    void clearHistory() {
+        m_history.clear();
+        m_counted.clear();
+        m_historyStride = 1;
+        m_counts.fill(0, kHeatW * kHeatH);
+        m_heat.fill(Qt::transparent);
+        if (!m_trailLayer.isNull()) m_trailLayer.fill(Qt::transparent);
+        update();
     }
 
 protected:
     /**
      * @brief mousePressEvent
-     * 點擊校正功能已移除，忽略事件
+     * 點擊校正在預覽畫面進行 (ClickableVideoWidget::clicked)，地圖忽略點擊
      */
     void mousePressEvent(QMouseEvent *event) override {
         Q_UNUSED(event);
         // 不做任何事
     }
 
+    /**
+     * @brief resizeEvent
+     * 尺寸改變時重建靜態圖層與軌跡圖層
+     */
+    void resizeEvent(QResizeEvent *event) override {
+        QWidget::resizeEvent(event);
+        rebuildLayers();
+    }
+
     /**
      * @brief paintEvent
-     * 畫出地圖、中心虛線與紅色十字及圓點
+     * 只合成髒矩形範圍內的靜態圖層、熱圖、軌跡與目前標記
      */
-    void paintEvent(QPaintEvent *) override {
+    void paintEvent(QPaintEvent *event) override {
+        PerfTimer timer("map.paint.ms");
+        TRACE_SCOPE("map.paint", "paint");
+        if (m_staticLayer.size() != size()) rebuildLayers();
+
+        const QRect dirty = event->rect();
         QPainter painter(this);
+        painter.setClipRect(dirty);
+
+        // 靜態圖層
+        painter.drawPixmap(dirty, m_staticLayer, dirty);
+
+        if (m_historyEnabled) {
+            // 熱圖：只取樣髒矩形對應的格子
+            const QRectF target = QRectF(m_mapRect).intersected(dirty);
+            if (!target.isEmpty()) {
+                const double cellW = double(m_mapRect.width()) / kHeatW;
+                const double cellH = double(m_mapRect.height()) / kHeatH;
+                const QRectF source((target.x() - m_mapRect.x()) / cellW,
+                                    (target.y() - m_mapRect.y()) / cellH,
+                                    target.width() / cellW, target.height() / cellH);
+                painter.setRenderHint(QPainter::SmoothPixmapTransform);
+                painter.drawImage(target, m_heat, source);
+            }
+
+            // 軌跡圖層
+            painter.drawPixmap(dirty, m_trailLayer, dirty);
+        }
+
+        // 將座標映射到地圖
+        const QPoint p = mapToWidget(m_currX, m_currY);
         painter.setRenderHint(QPainter::Antialiasing);
 
-        // 計算地圖大小，保持 16:9 比例
+        // 畫紅色十字
+        painter.setPen(QPen(Qt::red, 2));
+        painter.drawLine(p.x() - 12, p.y(), p.x() + 12, p.y());
+        painter.drawLine(p.x(), p.y() - 12, p.x(), p.y() + 12);
+
+        // 畫紅色圓點
+        painter.setBrush(Qt::red);
+        painter.drawEllipse(p.x() - 4, p.y() - 4, 8, 8);
+    }
+
+private:
+    static constexpr int kHeatW = 192;          ///< 熱圖格數 (寬)
+    static constexpr int kHeatH = 108;          ///< 熱圖格數 (高)
+    static constexpr int kHeatSaturate = 240;   ///< 累積到此次數時顏色飽和
+    static constexpr double kTrailBreak = 300;  ///< 相鄰兩點距離超過此值 (原始像素) 視為跳轉，不連線
+    static constexpr int kHistoryStepMs = 33;   ///< 歷史的時間格 (約一格 30fps 影格)
+    static constexpr int kMaxHistory = 20000;   ///< 保留的軌跡點上限，超過時抽稀
+
+    /**
+     * @brief 地圖區域：保持原始影片比例置中
+     */
+    QRect computeMapRect() const {
+        const int srcW = qMax(1, m_sourceSize.width()), srcH = qMax(1, m_sourceSize.height());
         int padding = 30;
         int mapW = width() - 2 * padding;
-        int mapH = mapW * 1080 / 1920;
+        int mapH = mapW * srcH / srcW;
 
         if (mapH > height() - 2 * padding) {
             mapH = height() - 2 * padding;
-            mapW = mapH * 1920 / 1080;
+            mapW = mapH * srcW / srcH;
+        }
+
+        return QRect((width() - mapW) / 2, (height() - mapH) / 2, mapW, mapH);
+    }
+
+    /**
+     * @brief 原始影片座標映射到 Widget 座標
+     */
+    QPoint mapToWidget(double x, double y) const {
+        return mapPoint(x, y, m_sourceSize, m_mapRect);
+    }
+
+    /**
+     * @brief 標記 (十字 + 圓點) 佔用的矩形，含畫筆寬度
+     */
+    QRect markerRect(double x, double y) const {
+        const QPoint p = mapToWidget(x, y);
+        return QRect(p.x() - 14, p.y() - 14, 29, 29);
+    }
+
+    /**
+     * @brief 重建靜態圖層 (背景、邊框、中心虛線、標題) 與軌跡圖層
+     */
+    void rebuildLayers() {
+        m_mapRect = computeMapRect();
+
+        m_staticLayer = QPixmap(size());
+        m_staticLayer.fill(Qt::white);
+        {
+            QPainter painter(&m_staticLayer);
+            painter.setRenderHint(QPainter::Antialiasing);
+
+            // 背景與邊框
+            painter.setBrush(QColor(245, 245, 245));
+            painter.setPen(QPen(Qt::darkGray, 2));
+            painter.drawRect(m_mapRect);
+
+            // 中心虛線
+            painter.setPen(QPen(QColor(210, 210, 210), 1, Qt::DashLine));
+            painter.drawLine(m_mapRect.center().x(), m_mapRect.top(), m_mapRect.center().x(), m_mapRect.bottom());
+            painter.drawLine(m_mapRect.left(), m_mapRect.center().y(), m_mapRect.right(), m_mapRect.center().y());
+
+            // 提示文字
+            painter.setPen(Qt::black);
+            painter.drawText(m_mapRect.left(), m_mapRect.top() - 10, "座標監控");
         }
 
-        QRect mapRect((width() - mapW) / 2, (height() - mapH) / 2, mapW, mapH);
+        // 軌跡需要依新尺寸重新映射，只在 resize 時整段重畫
+        m_trailLayer = QPixmap(size());
+        m_trailLayer.fill(Qt::transparent);
+        redrawTrail();
+    }
 
-        // 背景與邊框
-        painter.setBrush(QColor(245, 245, 245));
-        painter.setPen(QPen(Qt::darkGray, 2));
-        painter.drawRect(mapRect);
+    /**
+     * @brief 依時間順序重畫整段軌跡線 (resize 或抽稀後)
+     */
+    void redrawTrail() {
+        if (m_trailLayer.isNull()) return;
+        m_trailLayer.fill(Qt::transparent);
+        QPainter trail(&m_trailLayer);
+        setupTrailPen(trail);
+        for (auto it = m_history.cbegin(); it != m_history.cend(); ++it) {
+            auto next = std::next(it);
+            if (next != m_history.cend() && next.key() - it.key() <= m_historyStride) {
+                drawTrailSegment(trail, it.value(), next.value());
+            }
+        }
+    }
 
-        // 中心虛線
-        painter.setPen(QPen(QColor(210, 210, 210), 1, Qt::DashLine));
-        painter.drawLine(mapRect.center().x(), mapRect.top(), mapRect.center().x(), mapRect.bottom());
-        painter.drawLine(mapRect.left(), mapRect.center().y(), mapRect.right(), mapRect.center().y());
+    /**
+     * @brief 加入一筆歷史座標，增量更新熱圖格與軌跡線
+     * @param step 軌跡時間格 (kHistoryStepMs)；已計數的時間格不重複累積
+     * @return 受影響的 Widget 矩形
+     */
+    QRect appendHistory(double x, double y, qint64 step) {
+        if (step >= std::numeric_limits<int>::max()) return QRect();
+        const double srcW = m_sourceSize.width(), srcH = m_sourceSize.height();
+        const QPointF pt(qBound(0.0, x, srcW), qBound(0.0, y, srcH));
+        QRect dirty;
 
-        // 將座標映射到地圖
-        double normX = qBound(0.0, m_currX, 1920.0);
-        double normY = qBound(0.0, m_currY, 1080.0);
-        int drawX = mapRect.left() + (normX / 1920.0) * mapW;
-        int drawY = mapRect.top() + (normY / 1080.0) * mapH;
+        // 熱圖：每個時間格只計數一次，只重新著色被命中的那一格 (格子依影片比例拉伸)
+        if (step >= m_counted.size()) m_counted.resize(int(qMax<qint64>(step + 1, m_counted.size() * 2LL)));
+        if (!m_counted.testBit(int(step))) {
+            m_counted.setBit(int(step));
+            const int cx = qMin(kHeatW - 1, static_cast<int>(pt.x() / srcW * kHeatW));
+            const int cy = qMin(kHeatH - 1, static_cast<int>(pt.y() / srcH * kHeatH));
+            quint32 &count = m_counts[cy * kHeatW + cx];
+            ++count;
+            m_heat.setPixel(cx, cy, heatColor(count));
 
-        // 畫紅色十字
-        painter.setPen(QPen(Qt::red, 2));
-        painter.drawLine(drawX - 12, drawY, drawX + 12, drawY);
-        painter.drawLine(drawX, drawY - 12, drawX, drawY + 12);
+            const double cellW = double(m_mapRect.width()) / kHeatW;
+            const double cellH = double(m_mapRect.height()) / kHeatH;
+            // 平滑縮放會影響相鄰格，擴大一格
+            dirty |= QRectF(m_mapRect.x() + (cx - 1) * cellW, m_mapRect.y() + (cy - 1) * cellH,
+                            cellW * 3, cellH * 3).toAlignedRect();
+        }
 
-        // 畫紅色圓點
-        painter.setBrush(Qt::red);
-        painter.drawEllipse(drawX - 4, drawY - 4, 8, 8);
+        // 軌跡：只保留抽稀間隔上的時間格，與時間上相鄰的點連線
+        if (step % m_historyStride != 0 || m_history.contains(step)) return dirty;
+        auto it = m_history.insert(step, pt);
 
-        // 提示文字
-        painter.setPen(Qt::black);
-        painter.drawText(mapRect.left(), mapRect.top() - 10, "座標監控");
+        if (m_history.size() > kMaxHistory) {
+            m_historyStride *= 2;
+            for (auto h = m_history.begin(); h != m_history.end();) {
+                h = (h.key() % m_historyStride != 0) ? m_history.erase(h) : std::next(h);
+            }
+            redrawTrail();
+            return rect();
+        }
+
+        if (!m_trailLayer.isNull()) {
+            QPainter trail(&m_trailLayer);
+            setupTrailPen(trail);
+            if (it != m_history.begin()) {
+                auto prev = std::prev(it);
+                if (step - prev.key() <= m_historyStride) dirty |= drawTrailSegment(trail, prev.value(), pt);
+            }
+            auto next = std::next(it);
+            if (next != m_history.end() && next.key() - step <= m_historyStride) {
+                dirty |= drawTrailSegment(trail, pt, next.value());
+            }
+        }
+        return dirty;
     }
 
-private:
-    double m_currX, m_currY; ///< 當前追蹤座標
+    void setupTrailPen(QPainter &painter) const {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(QColor(0, 150, 200, 160), 1.5));
+    }
+
+    /**
+     * @brief 畫一段軌跡線，跳轉 (seek) 造成的大距離不連線
+     * @return 該段線在 Widget 上的範圍
+     */
+    QRect drawTrailSegment(QPainter &painter, const QPointF &from, const QPointF &to) const {
+        if (QLineF(from, to).length() > kTrailBreak) return QRect();
+
+        const QPoint a = mapToWidget(from.x(), from.y());
+        const QPoint b = mapToWidget(to.x(), to.y());
+        painter.drawLine(a, b);
+        return QRect(a, b).normalized().adjusted(-2, -2, 2, 2);
+    }
+
+    /**
+     * @brief 佔據次數對應的熱圖顏色：藍 → 紅，對數刻度，固定上限
+     * 使用固定飽和值，新增一筆只需重新著色一格
+     */
+    static QRgb heatColor(quint32 count) {
+        const double t = qMin(1.0, qLn(1.0 + count) / qLn(1.0 + kHeatSaturate));
+        QColor c = QColor::fromHsvF(0.66 * (1.0 - t), 1.0, 1.0);
+        c.setAlphaF(0.15 + 0.6 * t);
+        return qPremultiply(c.rgba());
+    }
+
+    double m_currX, m_currY;        ///< 當前追蹤座標
+    QSize m_sourceSize{1920, 1080}; ///< 原始影片尺寸 (座標範圍)
+    QRect m_mapRect;                ///< 地圖區域 (Widget 座標)
+    QPixmap m_staticLayer;          ///< 靜態圖層快取，resize 時重建
+    QPixmap m_trailLayer;           ///< 軌跡線圖層，增量繪製
+    QImage m_heat;                  ///< 熱圖 (每格一個像素)
+    QVector<quint32> m_counts;      ///< 每格累積次數
+    QMap<qint64, QPointF> m_history; ///< 時間格 → 歷史座標 (原始影片座標)，resize 時重畫軌跡用
+    QBitArray m_counted;            ///< 已計入熱圖的時間格
+    int m_historyStride = 1;        ///< 軌跡點的時間格間隔 (抽稀後加倍)
+    bool m_historyEnabled = false;  ///< 是否顯示軌跡與熱圖
 };
 
 #endif // VISUALMAP_H
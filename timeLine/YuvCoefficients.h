@@ -0,0 +1,57 @@
+#ifndef YUVCOEFFICIENTS_H
+#define YUVCOEFFICIENTS_H
+
+#include <QVideoFrameFormat>
+#include <QtMath>
+
+/**
+ * @brief YUV → RGB 整數轉換係數 (乘以 256)
+ *
+ * 預覽取樣 (ClickableVideoWidget) 與分析用的 BGR 轉換 (VideoFrameMat) 共用，
+ * 兩者對同一張影格得到相同的顏色。
+ */
+struct YuvCoefficients {
+    int y;              ///< 亮度倍率
+    int yOffset;        ///< 亮度黑位 (limited range 為 16)
+    int rv, gu, gv, bu;
+    bool bt601Limited;  ///< BT.601 limited range (與 OpenCV COLOR_YUV2BGR_* 相同)
+};
+
+/**
+ * @brief 依影格的色彩空間 (BT.601 / 709 / 2020) 與範圍 (limited / full) 計算轉換係數
+ * 格式未標示色彩空間時，高度超過 576 視為 HD (BT.709)，否則為 SD (BT.601)；未標示範圍時視為 limited
+ */
+inline YuvCoefficients yuvCoefficients(const QVideoFrameFormat &format)
+{
+    double kr = 0.299, kb = 0.114;  // BT.601
+    switch (format.colorSpace()) {
+    case QVideoFrameFormat::ColorSpace_BT709:
+        kr = 0.2126; kb = 0.0722;
+        break;
+    case QVideoFrameFormat::ColorSpace_BT2020:
+        kr = 0.2627; kb = 0.0593;
+        break;
+    case QVideoFrameFormat::ColorSpace_Undefined:
+        if (format.frameHeight() > 576) { kr = 0.2126; kb = 0.0722; }
+        break;
+    default:
+        break;
+    }
+    const double kg = 1.0 - kr - kb;
+
+    const bool full = format.colorRange() == QVideoFrameFormat::ColorRange_Full;
+    const double ys = full ? 1.0 : 255.0 / 219.0;
+    const double cs = (full ? 1.0 : 255.0 / 224.0) * 256.0;
+
+    YuvCoefficients k;
+    k.y            = qRound(ys * 256.0);
+    k.yOffset      = full ? 0 : 16;
+    k.rv           = qRound(2.0 * (1.0 - kr) * cs);
+    k.gu           = qRound(2.0 * kb * (1.0 - kb) / kg * cs);
+    k.gv           = qRound(2.0 * kr * (1.0 - kr) / kg * cs);
+    k.bu           = qRound(2.0 * (1.0 - kb) * cs);
+    k.bt601Limited = kr == 0.299 && !full;
+    return k;
+}
+
+#endif // YUVCOEFFICIENTS_H
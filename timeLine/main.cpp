@@ -1,10 +1,41 @@
 #include "timeLine.h"
+#include "PerfMetrics.h"
+#include "Trace.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QThread>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // --metrics <path>：結束時輸出效能指標 (.json 或 .csv)
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption metricsOption("metrics", "結束時將效能指標寫入檔案 (.json / .csv)", "path");
+    parser.addOption(metricsOption);
+    // --trace <path>：記錄追蹤事件，結束時寫成 Chrome trace JSON (Perfetto 可開啟)
+    QCommandLineOption traceOption("trace", "結束時將追蹤事件寫成 Chrome trace JSON", "path");
+    parser.addOption(traceOption);
+    parser.process(a);
+
+    const QString metricsPath = parser.value(metricsOption);
+    if (!metricsPath.isEmpty()) {
+        QObject::connect(&a, &QApplication::aboutToQuit, [metricsPath]() {
+            PerfMetrics::instance().dump(metricsPath);
+        });
+    }
+
+    const QString tracePath = parser.value(traceOption);
+    if (!tracePath.isEmpty()) {
+        QThread::currentThread()->setObjectName("GUI");
+        trace::start();
+        QObject::connect(&a, &QApplication::aboutToQuit, [tracePath]() {
+            trace::write(tracePath);
+        });
+    }
+
     timeLine w;
     w.show();
     return a.exec();
@@ -4,12 +4,48 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 CONFIG += c++17
 
 SOURCES += main.cpp \
-           timeLine.cpp
+           timeLine.cpp \
+           FilmstripWidget.cpp \
+           KeyframeIndex.cpp \
+           LiveTracker.cpp \
+           FrameCache.cpp \
+           ExportWriter.cpp \
+           MediaStore.cpp \
+           MultiFormatExport.cpp \
+           PerfMetrics.cpp \
+           PersonDetector.cpp \
+           ProjectFile.cpp \
+           ProxyMedia.cpp \
+           SegmentedExport.cpp \
+           Trace.cpp \
+           TrackCorrection.cpp \
+           VideoFrameMat.cpp
 
 HEADERS += ClickableVideoWidget.h \
+           ExportWriter.h \
+           FilmstripWidget.h \
+           FrameCache.h \
+           KeyframeIndex.h \
+           LiveTracker.h \
+           MediaHash.h \
+           MediaStore.h \
+           MultiFormatExport.h \
+           PerfHud.h \
+           PerfMetrics.h \
+           PersonDetector.h \
+           ProjectFile.h \
+           ProxyMedia.h \
+           SegmentedExport.h \
+           Trace.h \
+           TrackCorrection.h \
+           VideoFrameMat.h \
            VisualMap.h \
+           YuvCoefficients.h \
            timeLine.h
 
+# 核心程式庫 (軌跡、鏡頭路徑)
+include(../core/core.pri)
+
 # OpenCV Include
 INCLUDEPATH += D:/package_for_C++/OpenCV-MinGW-Build-OpenCV-4.5.5-x64/include
 
@@ -17,6 +53,7 @@ INCLUDEPATH += D:/package_for_C++/OpenCV-MinGW-Build-OpenCV-4.5.5-x64/include
 win32 {
     LIBS += -LD:/package_for_C++/OpenCV-MinGW-Build-OpenCV-4.5.5-x64/x64/mingw/lib \
             -lopencv_core455 \
+            -lopencv_dnn455 \
             -lopencv_highgui455 \
             -lopencv_imgcodecs455 \
             -lopencv_imgproc455 \
@@ -11,8 +11,6 @@
 #include <QSlider>
 #include <QDebug>
 #include <QTimer>
-#include <QScrollArea>
-#include <QScrollBar>
 #include <QApplication>
 #include <QProcess>
 #include <QProgressDialog>
@@ -22,6 +20,33 @@
 #include <QMessageBox>
 #include <QDir>
 #include <QDateTime>
+#include <QCheckBox>
+#include <QThreadPool>
+#include <QVideoSink>
+#include <QShortcut>
+#include <QSpinBox>
+#include "MediaHash.h"
+#include "ProxyMedia.h"
+#include "ProjectFile.h"
+#include "ExportWriter.h"
+#include "SegmentedExport.h"
+#include "CropScript.h"
+#include "TrackCorrection.h"
+#include <QSaveFile>
+#include <QBuffer>
+#include <QDockWidget>
+#include <QPointer>
+#include <QRegularExpression>
+#include <limits>
+
+namespace {
+
+constexpr double kMinAutoZoomHeight = 240;  ///< 自動縮放 ROI 最小高度 (1080p 像素)，避免放大到只剩雜訊
+constexpr char kExportFilter[] = "影片 (*.mp4 *.mkv *.mov *.avi)";  ///< 輸出對話框；副檔名決定容器
+constexpr qint64 kSegmentCacheBudget = 8LL << 30;   ///< 輸出片段快取上限 (8 GB)
+constexpr int kLiveReplanMs = 100;          ///< 即時追蹤結果最多累積多久才重新規劃鏡頭路徑
+
+} // namespace
 
 /**
  * @brief timeLine Constructor
@@ -37,6 +62,8 @@ timeLine::timeLine(QWidget *parent)
 
     // --- 狀態列 ---
     setStatusBar(new QStatusBar(this));
+    m_lblLatency = new QLabel("幀延遲 -- ms");
+    statusBar()->addPermanentWidget(m_lblLatency);
 
     // --- 全域樣式 ---
     setStyleSheet(R"(
@@ -49,6 +76,26 @@ timeLine::timeLine(QWidget *parent)
         QSlider::handle:horizontal { background:#00bcd4; width:14px; margin:-5px 0; border-radius:7px; }
     )");
 
+    // --- 影片庫：存檔以雜湊引用影片，不重複複製 ---
+    m_mediaStore = new MediaStore(QDir::currentPath() + "/save/media", this);
+    connect(m_mediaStore, &MediaStore::importProgress, this, [this](const QString &, qint64 done, qint64 total) {
+        if (total > 0) statusBar()->showMessage(QString("儲存影片 %1%").arg(done * 100 / total), 2000);
+    });
+    connect(m_mediaStore, &MediaStore::imported, this, [this](const QString &hash, const QString &storedPath) {
+        // 影片已在庫中：以連結放進等待中的存檔資料夾 (不支援連結時只保留 media.ref)
+        const QStringList links = m_pendingLinks.values(hash);
+        m_pendingLinks.remove(hash);
+        if (storedPath.isEmpty()) {
+            statusBar()->showMessage("⚠️ 影片無法存入影片庫", 3000);
+            return;
+        }
+        m_storedMedia.insert(hash, storedPath);
+        for (const QString &link : links) {
+            if (QFile::exists(link) || MediaStore::linkStored(storedPath, link)) continue;
+            statusBar()->showMessage("⚠️ 無法在存檔資料夾建立影片連結 (跨磁碟區或不支援)，只保留 media.ref", 5000);
+        }
+    });
+
     // --- 媒體播放器初始化 ---
     m_player = new QMediaPlayer(this);
     m_audioOutput = new QAudioOutput(this);
@@ -71,27 +118,23 @@ timeLine::timeLine(QWidget *parent)
     videoTitle->setObjectName("Title");
     videoLayout->addWidget(videoTitle);
 
-    QScrollArea *scrollArea = new QScrollArea(videoCard);
-    scrollArea->setWidgetResizable(false);
-    scrollArea->setFrameShape(QFrame::NoFrame);
-    scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    scrollArea->setStyleSheet("background: #000000; border-radius: 8px;");
-    scrollArea->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    // 只繪製 ROI 的預覽 Widget，由 QVideoSink 供應畫面
+    m_videoWidget = new ClickableVideoWidget(videoCard);
+    m_videoWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    m_videoWidget->setToolTip("Ctrl + 點擊人物：從此影格重新追蹤");
+    m_player->setVideoSink(m_videoWidget->videoSink());
 
-    m_videoWidget = new ClickableVideoWidget();
-    m_player->setVideoOutput(m_videoWidget);
-    m_videoWidget->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-
-    QWidget *container = new QWidget();
-    container->setStyleSheet("background: transparent;");
-    QVBoxLayout *containerLayout = new QVBoxLayout(container);
-    containerLayout->addWidget(m_videoWidget);
+    // 每張影格依其時間戳計算 ROI，鏡頭逐幀跟隨
+    m_videoWidget->setRoiProvider([this](qint64 timeUs) {
+        return cameraRoiAt(timeUs / 1.0e6);
+    });
 
-    scrollArea->setWidget(container);
-    m_videoContainer = scrollArea;
+    videoLayout->addWidget(m_videoWidget, 1);
 
-    videoLayout->addWidget(scrollArea, 1);
+    // 效能疊加 (F3 切換)
+    m_perfOverlay = new PerfHud(true, m_videoWidget);
+    m_perfOverlay->move(8, 8);
+    m_perfOverlay->hide();
     mainLayout->addWidget(videoCard, 5);
 
     // -------------------------
@@ -101,8 +144,10 @@ timeLine::timeLine(QWidget *parent)
     timeCard->setObjectName("Card");
     QVBoxLayout *timeLayout = new QVBoxLayout(timeCard);
 
+    m_filmstrip  = new FilmstripWidget(timeCard);
     m_timeSlider = new QSlider(Qt::Horizontal);
     timeLayout->addWidget(new QLabel("時間軸", timeCard));
+    timeLayout->addWidget(m_filmstrip);
     timeLayout->addWidget(m_timeSlider);
     mainLayout->addWidget(timeCard);
 
@@ -119,23 +164,57 @@ timeLine::timeLine(QWidget *parent)
     QVBoxLayout *controlLayout = new QVBoxLayout(controlCard);
 
     QPushButton *btnLoadCSV = new QPushButton("📂 讀取存檔");
+    QPushButton *btnOpenProject = new QPushButton("📁 開啟專案");
+    QPushButton *btnSaveProject = new QPushButton("💾 儲存專案");
     QPushButton *btnExport  = new QPushButton("💾 輸出校正影片");
+    QPushButton *btnExportMulti = new QPushButton("🎞️ 多比例輸出");
+    QPushButton *btnExportScript = new QPushButton("📝 輸出裁切腳本");
     m_btnPlayPause          = new QPushButton("⏸️ 暫停");
     QPushButton *btnLoad    = new QPushButton("🔍️ 追蹤");
+    m_btnLive               = new QPushButton("📡 即時追蹤");
+    m_btnLive->setCheckable(true);
 
     QLabel *lblScale   = new QLabel("縮放比例:");
     m_sliderScale      = new QSlider(Qt::Horizontal);
     m_sliderScale->setRange(50, 150); // 對應 0.5x ~ 1.5x
     m_sliderScale->setValue(100);     // 預設 1.0x
 
+    QCheckBox *chkHistory = new QCheckBox("顯示軌跡 / 熱圖");
+    m_chkAutoZoom         = new QCheckBox("自動縮放 (依人物大小)");
+    QCheckBox *chkPerf    = new QCheckBox("效能指標面板");
+
+    // 逐格檢視與影格快取預算
+    QPushButton *btnPrevFrame = new QPushButton("⏮ 上一格");
+    QPushButton *btnNextFrame = new QPushButton("下一格 ⏭");
+    QHBoxLayout *stepLayout = new QHBoxLayout;
+    stepLayout->addWidget(btnPrevFrame);
+    stepLayout->addWidget(btnNextFrame);
+
+    QSpinBox *spinCacheMB = new QSpinBox;
+    spinCacheMB->setRange(64, 8192);
+    spinCacheMB->setSingleStep(64);
+    spinCacheMB->setValue(512);
+    spinCacheMB->setSuffix(" MB");
+    spinCacheMB->setPrefix("影格快取 ");
+
     // 控制按鈕加入布局
     controlLayout->addStretch();
+    controlLayout->addWidget(btnOpenProject);
+    controlLayout->addWidget(btnSaveProject);
     controlLayout->addWidget(btnLoadCSV);
     controlLayout->addWidget(m_btnPlayPause);
     controlLayout->addWidget(btnLoad);
+    controlLayout->addWidget(m_btnLive);
     controlLayout->addWidget(lblScale);
     controlLayout->addWidget(m_sliderScale);
+    controlLayout->addWidget(m_chkAutoZoom);
+    controlLayout->addWidget(chkHistory);
+    controlLayout->addWidget(chkPerf);
+    controlLayout->addLayout(stepLayout);
+    controlLayout->addWidget(spinCacheMB);
     controlLayout->addWidget(btnExport);
+    controlLayout->addWidget(btnExportMulti);
+    controlLayout->addWidget(btnExportScript);
 
     // 加入底部 layout
     bottomLayout->addWidget(m_visualMap, 3);
@@ -144,31 +223,265 @@ timeLine::timeLine(QWidget *parent)
 
     setCentralWidget(central);
 
+    // 效能指標面板 (與疊加相同的數據)
+    QDockWidget *perfDock = new QDockWidget("效能指標", this);
+    perfDock->setWidget(new PerfHud(false, perfDock));
+    addDockWidget(Qt::RightDockWidgetArea, perfDock);
+    perfDock->hide();
+
     // -------------------------
     // 連接信號槽
     // -------------------------
     connect(m_sliderScale, &QSlider::valueChanged, this, &timeLine::applyManualAdjust);
+    connect(m_videoWidget, &ClickableVideoWidget::viewportResized, this, &timeLine::onViewportResized);
+
+    // 縮放輸入到畫面更新的延遲，與影格間隔比較
+    connect(m_videoWidget, &ClickableVideoWidget::painted, this, [this]() {
+        if (!m_scaleInput.isValid()) return;
+        double ms = m_scaleInput.nsecsElapsed() / 1.0e6;
+        double frameMs = 1000.0 / (m_frameCache->fps() > 0 ? m_frameCache->fps() : 30.0);
+        statusBar()->showMessage(QString("縮放更新 %1 ms (影格間隔 %2 ms)%3")
+                                     .arg(ms, 0, 'f', 1).arg(frameMs, 0, 'f', 1)
+                                     .arg(ms > frameMs ? " ⚠️" : ""), 2000);
+        m_scaleInput.invalidate();
+    });
     connect(btnLoad, &QPushButton::clicked, this, &timeLine::loadFile);
+    connect(m_videoWidget, &ClickableVideoWidget::correctionRequested, this, &timeLine::correctTrackingAt);
+    connect(m_btnLive, &QPushButton::toggled, this, &timeLine::toggleLiveTracking);
     connect(btnLoadCSV, &QPushButton::clicked, this, &timeLine::loadFileAndCSV);
+    connect(btnOpenProject, &QPushButton::clicked, this, &timeLine::openProject);
+    connect(btnSaveProject, &QPushButton::clicked, this, &timeLine::saveProject);
     connect(m_btnPlayPause, &QPushButton::clicked, this, &timeLine::togglePlayPause);
     connect(m_player, &QMediaPlayer::positionChanged, this, &timeLine::onPositionChanged);
-    connect(m_timeSlider, &QSlider::sliderMoved, m_player, &QMediaPlayer::setPosition);
+    // 拖曳時間軸：合併請求並對齊關鍵幀，放開時精確跳轉
+    m_seekWatchdog = new QTimer(this);
+    m_seekWatchdog->setSingleShot(true);
+    m_seekWatchdog->setInterval(200);
+    connect(m_seekWatchdog, &QTimer::timeout, this, &timeLine::onSeekSettled);
+    connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, this, &timeLine::onSeekSettled);
+    connect(m_timeSlider, &QSlider::sliderMoved, this, [this](int value) { requestSeek(value, false); });
+    connect(m_timeSlider, &QSlider::sliderReleased, this, [this]() { requestSeek(m_timeSlider->value(), true); });
+    connect(m_filmstrip, &FilmstripWidget::seekRequested, this, &timeLine::requestSeek);
+
+    // 取得影片長度後才建立縮圖膠卷 (背景解碼)
+    connect(m_player, &QMediaPlayer::durationChanged, this, [this](qint64 duration) {
+        if (duration <= 0) return;
+        m_filmstrip->setSource(m_player->source().toLocalFile(), duration);
+        m_frameCache->open(m_player->source().toLocalFile());
+        m_frameCache->setKeyframes(m_keyframes.times());
+        m_stepFrame = -1;
+    });
+
+    // -------------------------
+    // 逐格與 J/K/L 穿梭
+    // -------------------------
+    m_frameCache = new FrameCache(this);
+    m_frameCache->setMemoryBudget(spinCacheMB->value() * 1024LL * 1024LL);
+    connect(spinCacheMB, &QSpinBox::valueChanged, this, [this](int mb) {
+        m_frameCache->setMemoryBudget(mb * 1024LL * 1024LL);
+    });
+    connect(m_frameCache, &FrameCache::frameReady, this, [this](int index) {
+        if (index == m_stepFrame) showCachedFrame(index);
+    });
+
+    m_shuttleTimer = new QTimer(this);
+    m_shuttleTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_shuttleTimer, &QTimer::timeout, this, &timeLine::onShuttleTick);
+
+    // -------------------------
+    // 即時追蹤：播放器已解碼的影格直接送進追蹤執行緒
+    // -------------------------
+    m_liveTracker = new LiveTracker(this);
+    m_liveReplan = new QTimer(this);
+    m_liveReplan->setSingleShot(true);
+    m_liveReplan->setInterval(kLiveReplanMs);
+    connect(m_liveReplan, &QTimer::timeout, this, &timeLine::replanCameraPath);
+    connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, m_liveTracker, &LiveTracker::submit);
+    connect(m_liveTracker, &LiveTracker::detected, this, &timeLine::onLiveDetection, Qt::QueuedConnection);
+    connect(m_liveTracker, &LiveTracker::statsUpdated, this,
+            [this](double trackerFps, double playbackFps, qint64 dropped) {
+        if (!m_liveTracker->isRunning()) return;
+        statusBar()->showMessage(QString("即時追蹤 %1 fps / 播放 %2 fps，略過 %3 格%4")
+                                     .arg(trackerFps, 0, 'f', 1).arg(playbackFps, 0, 'f', 1).arg(dropped)
+                                     .arg(trackerFps < playbackFps * 0.95 ? " ⚠️" : ""), 1500);
+    }, Qt::QueuedConnection);
+
+    connect(btnPrevFrame, &QPushButton::clicked, this, [this]() { stepFrame(-1); });
+    connect(btnNextFrame, &QPushButton::clicked, this, [this]() { stepFrame(1); });
+    // 逐格、J/K/L 穿梭與入出點快捷鍵只在預覽畫面有焦點時作用，時間軸滑桿與數值框仍可用方向鍵與輸入文字
+    m_videoWidget->setFocusPolicy(Qt::StrongFocus);
+    auto videoShortcut = [this](const QKeySequence &key) {
+        auto *shortcut = new QShortcut(key, m_videoWidget);
+        shortcut->setContext(Qt::WidgetWithChildrenShortcut);
+        return shortcut;
+    };
+    connect(videoShortcut(Qt::Key_Left), &QShortcut::activated, this, [this]() { stepFrame(-1); });
+    connect(videoShortcut(Qt::Key_Right), &QShortcut::activated, this, [this]() { stepFrame(1); });
+    connect(videoShortcut(Qt::Key_J), &QShortcut::activated, this, &timeLine::shuttleReverse);
+    connect(videoShortcut(Qt::Key_K), &QShortcut::activated, this, &timeLine::shuttlePause);
+    connect(videoShortcut(Qt::Key_L), &QShortcut::activated, this, &timeLine::shuttleForward);
+    connect(videoShortcut(Qt::Key_I), &QShortcut::activated, this, [this]() { setExportMark(true); });
+    connect(videoShortcut(Qt::Key_O), &QShortcut::activated, this, [this]() { setExportMark(false); });
+    connect(videoShortcut(Qt::CTRL | Qt::SHIFT | Qt::Key_X), &QShortcut::activated,
+            this, [this]() { setExportMark(true, true); });
     connect(btnExport, &QPushButton::clicked, this, &timeLine::exportCorrectedVideo);
+    connect(btnExportMulti, &QPushButton::clicked, this, &timeLine::exportMultiFormat);
+    connect(btnExportScript, &QPushButton::clicked, this, &timeLine::exportCropScript);
+    connect(chkHistory, &QCheckBox::toggled, m_visualMap, &VisualMap::setHistoryEnabled);
+    connect(m_chkAutoZoom, &QCheckBox::toggled, this, [this](bool on) {
+        m_autoZoom = on;
+        replanCameraPath();
+    });
+    connect(chkPerf, &QCheckBox::toggled, perfDock, &QDockWidget::setVisible);
+    connect(perfDock, &QDockWidget::visibilityChanged, chkPerf, &QCheckBox::setChecked);
+    connect(new QShortcut(QKeySequence(Qt::Key_F3), this), &QShortcut::activated, this, [this]() {
+        m_perfOverlay->setVisible(!m_perfOverlay->isVisible());
+        m_perfOverlay->raise();
+    });
+
+    // 影格到達 → 畫面更新的延遲，平滑後每 250ms 顯示一次
+    connect(m_videoWidget, &ClickableVideoWidget::frameLatency, this, [this](double ms) {
+        m_latencyAvg = (m_latencyAvg <= 0) ? ms : m_latencyAvg * 0.9 + ms * 0.1;
+        m_latencyMax = std::max(m_latencyMax, ms);
+
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (now - m_latencyShownAt >= 250) {
+            m_lblLatency->setText(QString("幀延遲 %1 ms (峰值 %2 ms)")
+                                      .arg(m_latencyAvg, 0, 'f', 1)
+                                      .arg(m_latencyMax, 0, 'f', 1));
+            m_latencyShownAt = now;
+            m_latencyMax = 0;
+        }
+    });
+}
+
+timeLine::~timeLine()
+{
+    // 背景工作以 invokeMethod(this) 回報：全部取消並等待結束，之後不會再有回呼排入
+    for (const std::weak_ptr<std::atomic_bool> &flag : std::as_const(m_cancelFlags)) {
+        if (auto cancel = flag.lock()) *cancel = true;
+    }
+    m_tasks.clear();
+    m_tasks.waitForDone();
+}
+
+std::shared_ptr<std::atomic_bool> timeLine::newCancelFlag()
+{
+    m_cancelFlags.removeIf([](const std::weak_ptr<std::atomic_bool> &flag) { return flag.expired(); });
+    auto cancel = std::make_shared<std::atomic_bool>(false);
+    m_cancelFlags.append(cancel);
+    return cancel;
 }
 
 // -------------------------
 // 播放 / 暫停
 // -------------------------
 void timeLine::togglePlayPause() {
-    if (m_player->playbackState() == QMediaPlayer::PlayingState) {
-        m_player->pause();
-        m_btnPlayPause->setText("▶️ 播放");
+    if (m_player->playbackState() == QMediaPlayer::PlayingState || m_shuttleSpeed < 0) {
+        shuttlePause();
     } else {
+        leaveStepMode();
         m_player->play();
         m_btnPlayPause->setText("⏸️ 暫停");
     }
 }
 
+// -------------------------
+// 逐格前進 / 後退
+// -------------------------
+void timeLine::stepFrame(int delta)
+{
+    if (!m_frameCache->isOpen()) return;
+
+    shuttlePause();
+
+    if (m_stepFrame < 0) m_stepFrame = m_frameCache->msToFrame(m_player->position());
+    m_stepFrame = qBound(0, m_stepFrame + delta, qMax(0, m_frameCache->frameCount() - 1));
+
+    // 游標與方向告訴解碼執行緒往哪邊預先解碼
+    m_frameCache->setCursor(m_stepFrame, delta >= 0 ? 1 : -1);
+    showCachedFrame(m_stepFrame);
+}
+
+void timeLine::showCachedFrame(int index)
+{
+    QImage image = m_frameCache->frame(index);
+    if (image.isNull()) return; // 解碼完成後由 frameReady 再次呼叫
+
+    qint64 ms = m_frameCache->frameToMs(index);
+    m_videoWidget->showStill(image, ms * 1000);
+    onPositionChanged(ms);
+}
+
+void timeLine::leaveStepMode()
+{
+    if (m_stepFrame < 0) return;
+
+    m_player->setPosition(m_frameCache->frameToMs(m_stepFrame));
+    m_stepFrame = -1;
+}
+
+// -------------------------
+// J/K/L 穿梭
+// -------------------------
+void timeLine::shuttleReverse()
+{
+    if (!m_frameCache->isOpen()) return;
+
+    if (m_shuttleSpeed >= 0) {
+        // 由正向或停止切換為反向 1x
+        if (m_player->playbackState() == QMediaPlayer::PlayingState) m_player->pause();
+        m_player->setPlaybackRate(1.0);
+        if (m_stepFrame < 0) m_stepFrame = m_frameCache->msToFrame(m_player->position());
+        m_shuttleSpeed = -1;
+    } else {
+        m_shuttleSpeed = qMax(-4, m_shuttleSpeed * 2);
+    }
+
+    m_frameCache->setCursor(m_stepFrame, -1);
+    m_shuttleTimer->start(qMax(1, static_cast<int>(1000.0 / (m_frameCache->fps() * -m_shuttleSpeed))));
+    m_btnPlayPause->setText("▶️ 播放");
+}
+
+void timeLine::shuttlePause()
+{
+    m_shuttleTimer->stop();
+    m_shuttleSpeed = 0;
+    m_player->setPlaybackRate(1.0);
+    if (m_player->playbackState() == QMediaPlayer::PlayingState) m_player->pause();
+    m_btnPlayPause->setText("▶️ 播放");
+}
+
+void timeLine::shuttleForward()
+{
+    if (m_shuttleSpeed > 0 && m_player->playbackState() == QMediaPlayer::PlayingState) {
+        m_shuttleSpeed = qMin(4, m_shuttleSpeed * 2);
+    } else {
+        m_shuttleTimer->stop();
+        m_shuttleSpeed = 1;
+        leaveStepMode();
+        m_player->play();
+    }
+    m_player->setPlaybackRate(m_shuttleSpeed);
+    m_btnPlayPause->setText("⏸️ 暫停");
+}
+
+void timeLine::onShuttleTick()
+{
+    int next = m_stepFrame - 1;
+    if (next < 0) {
+        shuttlePause();
+        return;
+    }
+
+    // 下一格尚未解碼就停在目前畫面，等解碼執行緒追上，不跳格
+    m_frameCache->setCursor(next, -1);
+    if (m_frameCache->frame(next).isNull()) return;
+
+    m_stepFrame = next;
+    showCachedFrame(m_stepFrame);
+}
+
 // -------------------------
 // 選影片並自動追蹤 (Python 追蹤腳本)
 // -------------------------
@@ -177,8 +490,10 @@ void timeLine::loadFile() {
     QString video = QFileDialog::getOpenFileName(this, "選擇影片", "", "*.mp4 *.avi");
     if (video.isEmpty()) return;
 
-    // 2️⃣ 設定影片來源
-    m_player->setSource(QUrl::fromLocalFile(video));
+    // 2️⃣ 設定影片來源 (大影片播放代理檔)
+    openMedia(video);
+    m_projectPath.clear();
+    m_project.reset();
 
     // 3️⃣ Python 路徑與 CSV
     QString pythonExe  = "C:/Users/User/anaconda3/envs/Qt_11401_17/python.exe";
@@ -203,17 +518,26 @@ void timeLine::loadFile() {
         );
     progress->show();
 
-    // 5️⃣ 啟動 Python Process
+    // 5️⃣ 啟動 Python Process；存檔資料夾先決定好，追蹤腳本的 trace 與追蹤結果放在一起
+    const QString saveRoot = QDir::currentPath() + "/save/"
+                             + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
     QProcess *proc = new QProcess(this);
     QStringList args;
     args << scriptPath << "--input" << video << "--output" << csvPath;
+    if (trace::enabled() && QDir().mkpath(saveRoot)) args << "--trace" << saveRoot + "/tracker.trace.json";
     proc->setProgram(pythonExe);
     proc->setArguments(args);
     proc->setProcessChannelMode(QProcess::MergedChannels);
 
     // 6️⃣ 讀 Python 輸出
     connect(proc, &QProcess::readyRead, this, [=](){
-        qDebug() << proc->readAll();
+        const QByteArray output = proc->readAll();
+        qDebug() << output;
+
+        // 追蹤腳本結束時輸出 "... (12.3 fps)"
+        static const QRegularExpression fpsPattern("\\(([0-9.]+) fps\\)");
+        const QRegularExpressionMatch match = fpsPattern.match(QString::fromUtf8(output));
+        if (match.hasMatch()) PerfMetrics::instance().record("tracker.fps", match.captured(1).toDouble());
     });
 
     // 7️⃣ 錯誤處理
@@ -229,21 +553,32 @@ void timeLine::loadFile() {
         progress->deleteLater();
 
         if (status == QProcess::NormalExit && QFile::exists(csvPath)) {
-            QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
-            QString saveRoot = QDir::currentPath() + "/save/" + timestamp;
             QDir().mkpath(saveRoot);
             m_saveFolder = saveRoot;
 
-            QFile::copy(m_player->source().toLocalFile(),
-                        m_saveFolder + "/" + QFileInfo(m_player->source().toLocalFile()).fileName());
             QFile::copy(csvPath, m_saveFolder + "/tracking.csv");
 
+            // 影片不複製到存檔：記錄雜湊，放入影片庫後再以 reflink / hardlink 放入
+            QString hash = quickMediaHash(m_sourcePath);
+            QFile ref(m_saveFolder + "/media.ref");
+            if (ref.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                QTextStream out(&ref);
+                out << hash << "\n" << QFileInfo(m_sourcePath).fileName() << "\n" << m_sourcePath << "\n";
+            }
+            m_pendingLinks.insert(hash, m_saveFolder + "/" + QFileInfo(m_sourcePath).fileName());
+            m_mediaStore->import(m_sourcePath, hash);
+
             loadCSV(csvPath);
+            prepareKeyframeIndex();
             m_player->setPosition(m_startTime * 1000);
             QTimer::singleShot(300, this, &timeLine::applyAutoZoom);
             m_player->play();
             m_btnPlayPause->setText("⏸️ 暫停");
 
+            // 存成單一專案檔，之後一次開啟
+            m_projectPath = m_saveFolder + "/session.tlproj";
+            saveProject();
+
         } else {
             qDebug() << "❌ Python crash 或 CSV 不存在";
         }
@@ -259,6 +594,149 @@ void timeLine::loadFile() {
         progress->deleteLater();
     }
 }
+// -------------------------
+// 即時追蹤 (播放中逐格偵測)
+// -------------------------
+void timeLine::toggleLiveTracking(bool on)
+{
+    if (!on) {
+        if (!m_liveTracker->isRunning()) return;
+        m_liveTracker->stop();
+        m_liveReplan->stop();
+        replanCameraPath();
+        statusBar()->showMessage(QString("即時追蹤已停止：軌跡 %1 筆").arg(m_dataPoints.size()), 3000);
+        return;
+    }
+
+    if (m_player->source().isEmpty()) {
+        QMessageBox::warning(this, "錯誤", "請先載入影片！");
+        m_btnLive->setChecked(false);
+        return;
+    }
+
+    QString error;
+    if (!m_liveTracker->start(PersonDetector::defaultModel(), &error)) {
+        QMessageBox::warning(this, "錯誤", error);
+        m_btnLive->setChecked(false);
+        return;
+    }
+
+    // 還沒有軌跡時時間軸先對應整支影片
+    if (m_dataPoints.isEmpty() && m_player->duration() > 0) {
+        m_startTime = 0;
+        m_endTime = m_player->duration() / 1000.0;
+        m_timeSlider->setRange(0, m_player->duration());
+    }
+    if (m_camW <= 0 || m_camH <= 0) applyAutoZoom();
+
+    leaveStepMode();
+    m_player->play();
+    m_btnPlayPause->setText("⏸️ 暫停");
+}
+
+// -------------------------
+// 即時追蹤結果 → 軌跡
+// -------------------------
+void timeLine::onLiveDetection(qint64 timeUs, const QRectF &box, const QSize &frameSize)
+{
+    if (!m_liveTracker->isRunning() || frameSize.isEmpty()) return;
+
+    // 播放代理檔時換算回原始影片座標
+    const double sx = m_sourceSize.isEmpty() ? 1.0 : double(m_sourceSize.width()) / frameSize.width();
+    const double sy = m_sourceSize.isEmpty() ? 1.0 : double(m_sourceSize.height()) / frameSize.height();
+    const DataPoint point = { timeUs / 1.0e6, box.center().x() * sx, box.center().y() * sy,
+                              box.width() * sx, box.height() * sy };
+
+    // 依時間插入；同一張影格 (半格以內) 已有數據時以新結果取代
+    m_dataPoints = spliceTrajectory(m_dataPoints, { point }, 0.5 / m_sourceFps);
+
+    m_startTime = qMin(m_startTime, m_dataPoints.first().time);
+    m_endTime   = qMax(m_endTime, m_dataPoints.last().time);
+
+    // 合併一段時間內的結果再規劃，裁切跟隨延遲 ≤ 偵測時間 + kLiveReplanMs
+    if (!m_liveReplan->isActive()) m_liveReplan->start();
+}
+
+// -------------------------
+// 點擊校正 (Ctrl + 點擊，從點擊的影格往後重新追蹤)
+// -------------------------
+void timeLine::correctTrackingAt(const QPoint &pos)
+{
+    const qint64 timeUs = m_videoWidget->frameTime();
+    const QPointF seed = m_videoWidget->mapToSource(pos);
+    if (m_correcting || m_sourcePath.isEmpty() || timeUs < 0 || seed.x() < 0) return;
+    m_correcting = true;
+
+    // 即時追蹤會覆寫同一段軌跡；校正期間停在點擊的畫面
+    m_btnLive->setChecked(false);
+    shuttlePause();
+
+    TrackCorrection::Job job;
+    job.source     = m_sourcePath;
+    job.model      = PersonDetector::defaultModel();
+    job.fps        = m_sourceFps;
+    job.startFrame = qRound(timeUs / 1.0e6 * m_sourceFps);
+    job.seed       = seed;
+    job.trajectory = m_dataPoints;
+
+    const int remaining = m_sourceFrames > job.startFrame ? m_sourceFrames - job.startFrame : 0;
+    QProgressDialog *progress = new QProgressDialog("重新追蹤中...", "取消", 0, remaining, this);
+    progress->setWindowTitle("校正追蹤");
+    progress->setWindowModality(Qt::ApplicationModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setStyleSheet(
+        "QProgressDialog { color: black; }"
+        "QLabel { color: black; }"
+        );
+    progress->show();       // 立即顯示：模型載入與第一格偵測前就擋住其他操作
+
+    // 關閉視窗時由解構子設定取消並等待結束；m_correcting 保持設定直到完成回呼
+    auto cancel = newCancelFlag();
+    connect(progress, &QProgressDialog::canceled, this, [cancel]() { *cancel = true; });
+
+    QPointer<QProgressDialog> dialog(progress);
+    const QString source = m_sourcePath;
+    m_tasks.start([=]() {
+        auto onProgress = [=](int done) {
+            QMetaObject::invokeMethod(this, [=]() {
+                if (dialog) dialog->setValue(qMin(done, dialog->maximum()));
+            }, Qt::QueuedConnection);
+        };
+
+        TrackCorrection::Result result;
+        QString error;
+        const bool ok = TrackCorrection::run(job, onProgress, *cancel, &result, &error);
+
+        QMetaObject::invokeMethod(this, [=]() {
+            m_correcting = false;
+            if (dialog) dialog->close();
+            if (m_sourcePath != source) return;     // 期間已換了影片
+            if (!ok) {
+                if (!*cancel) QMessageBox::warning(this, "校正失敗", error);
+                return;
+            }
+
+            // 只取代重新追蹤的區段，其餘軌跡不變
+            const bool wasEmpty = m_dataPoints.isEmpty();
+            m_dataPoints = spliceTrajectory(m_dataPoints, result.span, 0.5 / m_sourceFps);
+            m_startTime = wasEmpty ? m_dataPoints.first().time : qMin(m_startTime, m_dataPoints.first().time);
+            m_endTime   = wasEmpty ? m_dataPoints.last().time : qMax(m_endTime, m_dataPoints.last().time);
+            if (wasEmpty) m_timeSlider->setRange(m_startTime * 1000, m_endTime * 1000);
+            if (m_camW <= 0 || m_camH <= 0) applyAutoZoom();
+            replanCameraPath();
+            onPositionChanged(m_player->position());
+
+            statusBar()->showMessage(QString("已重新追蹤 %1 ~ %2 秒 (%3 筆)，%4")
+                                         .arg(result.span.first().time, 0, 'f', 2)
+                                         .arg(result.span.last().time, 0, 'f', 2)
+                                         .arg(result.span.size())
+                                         .arg(result.converged ? "已回到原軌跡" : "未收斂 (追到結尾或跟丟)"),
+                                     5000);
+        }, Qt::QueuedConnection);
+    });
+}
+
 // -------------------------
 // 選影片 + CSV（已有追蹤結果）
 // -------------------------
@@ -272,11 +750,15 @@ void timeLine::loadFileAndCSV()
     QString csvFile = QFileDialog::getOpenFileName(this, "選擇 CSV", "", "*.csv");
     if (csvFile.isEmpty()) return;
 
-    // 3️⃣ 設定影片來源
-    m_player->setSource(QUrl::fromLocalFile(video));
+    // 3️⃣ 設定影片來源 (大影片播放代理檔)
+    openMedia(video);
+    m_projectPath.clear();
+    m_project.reset();
 
-    // 4️⃣ 讀 CSV
+    // 4️⃣ 讀 CSV，關鍵幀索引與 CSV 放在同一資料夾
     loadCSV(csvFile);
+    m_saveFolder = QFileInfo(csvFile).absolutePath();
+    prepareKeyframeIndex();
 
     // 5️⃣ 自動播放影片
     m_player->setPosition(m_startTime * 1000);
@@ -285,30 +767,222 @@ void timeLine::loadFileAndCSV()
     m_btnPlayPause->setText("⏸️ 暫停");
 }
 
+// -------------------------
+// 開啟影片 / 代理檔
+// -------------------------
+void timeLine::openMedia(const QString &video)
+{
+    // 即時追蹤的結果屬於前一支影片
+    m_btnLive->setChecked(false);
+
+    // 前一支影片尚未完成的代理檔不再需要
+    if (m_proxyCancel) *m_proxyCancel = true;
+    m_proxyCancel.reset();
+
+    m_sourcePath = video;
+    cv::VideoCapture probe(video.toStdString());
+    m_sourceSize = probe.isOpened()
+                       ? QSize(static_cast<int>(probe.get(cv::CAP_PROP_FRAME_WIDTH)),
+                               static_cast<int>(probe.get(cv::CAP_PROP_FRAME_HEIGHT)))
+                       : QSize();
+    m_sourceFps    = probe.get(cv::CAP_PROP_FPS) > 0 ? probe.get(cv::CAP_PROP_FPS) : 30.0;
+    m_sourceFrames = qMax(0, static_cast<int>(probe.get(cv::CAP_PROP_FRAME_COUNT)));
+    m_markIn = m_markOut = -1;
+    probe.release();
+
+    // 軌跡座標屬於原始影片，地圖與預覽都依原始尺寸換算
+    m_visualMap->setSourceSize(m_sourceSize);
+    m_videoWidget->setSourceSize(m_sourceSize);
+
+    const QString hash = quickMediaHash(video);
+    const QString proxy = ProxyMedia::find(hash);
+    m_player->setSource(QUrl::fromLocalFile(proxy.isEmpty() ? video : proxy));
+    if (!proxy.isEmpty() || !ProxyMedia::needsProxy(m_sourceSize)) return;
+
+    // 先播放原始影片，背景產生代理檔後再切換
+    auto cancel = newCancelFlag();
+    m_proxyCancel = cancel;
+    m_tasks.start([=]() {
+        auto progress = [=](double ratio) {
+            QMetaObject::invokeMethod(this, [=]() {
+                if (*cancel) return;
+                statusBar()->showMessage(QString("產生預覽代理檔 %1%").arg(qRound(ratio * 100)), 2000);
+            }, Qt::QueuedConnection);
+        };
+        QString path = ProxyMedia::generate(video, hash, progress, *cancel);
+
+        QMetaObject::invokeMethod(this, [=]() {
+            if (*cancel || path.isEmpty()) return;
+            m_proxyCancel.reset();
+            switchToProxy(path);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void timeLine::switchToProxy(const QString &proxy)
+{
+    const qint64 position = m_player->position();
+    const bool playing = m_player->playbackState() == QMediaPlayer::PlayingState;
+
+    shuttlePause();
+    m_player->setSource(QUrl::fromLocalFile(proxy));
+    m_player->setPosition(position);
+    if (playing) {
+        m_player->play();
+        m_btnPlayPause->setText("⏸️ 暫停");
+    }
+
+    // 代理檔的 GOP 與原始影片不同，關鍵幀索引另外建立
+    prepareKeyframeIndex();
+    statusBar()->showMessage("已切換為預覽代理檔", 3000);
+}
+
+double timeLine::resolutionScale() const
+{
+    const int shortSide = qMin(m_sourceSize.width(), m_sourceSize.height());
+    return shortSide > 0 ? 1080.0 / shortSide : 1.0;
+}
+
+// -------------------------
+// 開啟專案檔：只讀標頭與段落表並保持映射，各段落在第一次用到時才解碼
+// -------------------------
+void timeLine::openProject()
+{
+    QString path = QFileDialog::getOpenFileName(this, "開啟專案", "./save", "*.tlproj");
+    if (path.isEmpty()) return;
+
+    TRACE_SCOPE("openProject", "io");
+    auto project = std::make_unique<ProjectFile>();
+    if (!project->open(path)) {
+        QMessageBox::warning(this, "錯誤", "無法讀取專案檔！");
+        return;
+    }
+    const ProjectHeader &header = project->header();
+
+    // 影片：優先使用影片庫，其次原始路徑
+    QString video;
+    for (const QString &candidate : { header.storedMedia, header.mediaPath }) {
+        if (!candidate.isEmpty() && QFile::exists(candidate)) {
+            video = candidate;
+            break;
+        }
+    }
+    if (video.isEmpty()) {
+        QMessageBox::warning(this, "錯誤", "找不到專案引用的影片：\n" + header.mediaPath);
+        return;
+    }
+    if (!header.storedMedia.isEmpty() && QFile::exists(header.storedMedia))
+        m_storedMedia.insert(header.mediaHash, header.storedMedia);
+
+    m_projectPath = path;
+    m_saveFolder  = QFileInfo(path).absolutePath();
+    openMedia(video);
+    m_project = std::move(project);
+
+    // 設定
+    m_currentScale = header.settings.value("scale/base", m_currentScale).toDouble();
+    m_sliderScale->setValue(qRound(header.settings.value("scale/manual", 1.0).toDouble() * 100));
+    m_deadZone        = header.settings.value("camera/deadZone", m_deadZone).toDouble();
+    m_maxVelocity     = header.settings.value("camera/maxVelocity", m_maxVelocity).toDouble();
+    m_maxAcceleration = header.settings.value("camera/maxAcceleration", m_maxAcceleration).toDouble();
+    m_subjectFill     = header.settings.value("zoom/subjectFill", m_subjectFill).toDouble();
+    m_chkAutoZoom->setChecked(header.settings.value("zoom/auto", false).toBool());
+
+    // 關鍵幀索引：播放原始影片時才解碼 KEYF 段落，播放代理檔時另外建立
+    prepareKeyframeIndex();
+
+    QVector<DataPoint> points;
+    {
+        TRACE_SCOPE("decodeTrajectory", "io");
+        points = decodeTrajectory(m_project->section(ProjectFile::kTrajectory));
+    }
+    setTrajectory(points);
+}
+
+// -------------------------
+// 儲存專案檔
+// -------------------------
+void timeLine::saveProject()
+{
+    if (m_sourcePath.isEmpty() || m_dataPoints.isEmpty()) {
+        QMessageBox::warning(this, "錯誤", "請先載入影片和 CSV！");
+        return;
+    }
+    if (m_projectPath.isEmpty()) {
+        m_projectPath = QFileDialog::getSaveFileName(this, "儲存專案",
+                                                     m_saveFolder.isEmpty() ? "./save" : m_saveFolder,
+                                                     "*.tlproj");
+        if (m_projectPath.isEmpty()) return;
+    }
+
+    ProjectHeader header;
+    header.mediaHash   = quickMediaHash(m_sourcePath);
+    header.mediaPath   = QFileInfo(m_sourcePath).absoluteFilePath();
+    header.storedMedia = m_storedMedia.value(header.mediaHash);
+    header.settings = {
+        { "scale/base", m_currentScale },
+        { "scale/manual", m_manualScale },
+        { "smoothing/mode", "planner" },
+        { "camera/deadZone", m_deadZone },
+        { "camera/maxVelocity", m_maxVelocity },
+        { "camera/maxAcceleration", m_maxAcceleration },
+        { "zoom/auto", m_autoZoom },
+        { "zoom/subjectFill", m_subjectFill },
+    };
+
+    QMap<quint32, QByteArray> sections;
+    sections.insert(ProjectFile::kTrajectory, encodeTrajectory(m_dataPoints));
+    if (!m_keyframes.isEmpty() && m_player->source().toLocalFile() == m_sourcePath) {
+        QBuffer keyframes;
+        keyframes.open(QIODevice::WriteOnly);
+        if (m_keyframes.save(&keyframes, header.mediaHash)) {
+            sections.insert(ProjectFile::kKeyframes, keyframes.data());
+        }
+    } else if (m_project && m_project->header().mediaHash == header.mediaHash
+               && m_project->hasSection(ProjectFile::kKeyframes)) {
+        // 播放代理檔時保留專案中原始影片的索引 (映射記憶體，關閉前深複製)
+        const QByteArray raw = m_project->section(ProjectFile::kKeyframes);
+        sections.insert(ProjectFile::kKeyframes, QByteArray(raw.constData(), raw.size()));
+    }
+
+    // 取代檔案前解除映射
+    m_project.reset();
+    const bool saved = ProjectFile::save(m_projectPath, header, sections);
+    m_project = std::make_unique<ProjectFile>();
+    if (!m_project->open(m_projectPath)) m_project.reset();
+    if (!saved) {
+        QMessageBox::warning(this, "錯誤", "無法寫入專案檔！");
+        return;
+    }
+    statusBar()->showMessage("專案已儲存：" + QFileInfo(m_projectPath).fileName(), 3000);
+}
+
 // -------------------------
 // 讀 CSV，更新 m_dataPoints
 // -------------------------
 void timeLine::loadCSV(const QString &csvFile)
 {
+    TRACE_SCOPE("loadCSV", "io");
     QFile f(csvFile);
     if (!f.open(QIODevice::ReadOnly)) return;
 
-    QTextStream in(&f);
-    m_dataPoints.clear();
+    setTrajectory(parseTrajectoryCsv(&f));
+}
 
-    while (!in.atEnd()) {
-        auto s = in.readLine().split(",");
-        if (s.size() >= 3) {
-            DataPoint d = { s[0].toDouble(), s[1].toDouble(), s[2].toDouble() };
-            m_dataPoints.append(d);
-        }
-    }
+// -------------------------
+// 套用軌跡
+// -------------------------
+void timeLine::setTrajectory(const QVector<DataPoint> &points)
+{
+    m_dataPoints = points;
+    m_visualMap->clearHistory();
 
     if (!m_dataPoints.isEmpty()) {
         m_startTime = m_dataPoints.first().time;
         m_endTime   = m_dataPoints.last().time;
         m_timeSlider->setRange(m_startTime * 1000, m_endTime * 1000);
     }
+    replanCameraPath();
 
     // 自動播放影片
     if (!m_player->source().isEmpty()) {
@@ -324,65 +998,242 @@ void timeLine::loadCSV(const QString &csvFile)
 // -------------------------
 void timeLine::applyAutoZoom()
 {
-    if (!m_videoContainer || !m_videoWidget) return;
-
-    QScrollArea *sa = qobject_cast<QScrollArea*>(m_videoContainer);
-    if (!sa) return;
-
-    // 實際可見尺寸
-    m_camW = sa->width();
-    m_camH = sa->height();
-
-    QWidget *container = sa->widget();
-    container->setFixedSize(m_camW, m_camH);
-
-    // 設定 VideoWidget 大小
-    m_videoWidget->setParent(container);
-    m_videoWidget->setFixedSize(static_cast<int>(1920 * m_currentScale),
-                                static_cast<int>(1080 * m_currentScale));
+    if (!m_videoWidget) return;
 
-    QApplication::processEvents();
+    // 實際可見尺寸 (預覽 Widget 大小固定，縮放只影響 ROI)
+    m_camW = m_videoWidget->width();
+    m_camH = m_videoWidget->height();
 
     // 立即更新位置
     QTimer::singleShot(0, this, [=]() {
+        replanCameraPath();
         onPositionChanged(m_player->position());
+        m_videoWidget->refreshRoi();
     });
 }
 
+// -------------------------
+// 預覽窗口尺寸改變：只更新 ROI 比例
+// -------------------------
+void timeLine::onViewportResized(const QSize &size)
+{
+    if (m_camW <= 0 || m_camH <= 0) return; // 尚未初始化縮放
+    m_camW = size.width();
+    m_camH = size.height();
+    replanCameraPath();
+}
+
 // -------------------------
 // 播放位置改變時呼叫
+// 只同步時間軸與地圖；預覽裁切由每張影格的時間戳驅動 (cameraRoiAt)
 // -------------------------
 void timeLine::onPositionChanged(qint64 position)
 {
+    PerfTimer timer("position.ms");
     double sec = position / 1000.0;
-    m_timeSlider->setValue(position);
+    if (!m_timeSlider->isSliderDown()) m_timeSlider->setValue(position);
+    m_filmstrip->setPlayhead(position);
 
     if (m_dataPoints.isEmpty()) return;
 
-    // 找到當前時間對應座標
-    const auto &pt = *std::lower_bound(
-        m_dataPoints.begin(), m_dataPoints.end(), sec,
-        [](const DataPoint &d, double t) { return d.time < t; });
-
     // 更新可視化地圖
-    m_visualMap->updatePosition(pt.x, pt.y);
+    QPointF pt = samplePosition(sec);
+    m_visualMap->updatePosition(pt.x(), pt.y(), sec);
+}
+
+// -------------------------
+// 跳轉請求：只保留最新一筆，前一次完成後才送出
+// -------------------------
+void timeLine::requestSeek(qint64 ms, bool exact)
+{
+    // 跳轉後由播放器供應畫面
+    m_stepFrame = -1;
+    if (m_shuttleSpeed < 0) shuttlePause();
+
+    // 拖曳中對齊最近的關鍵幀，解碼器不需從 GOP 起點往後解
+    qint64 target = exact ? ms : m_keyframes.nearest(ms);
+
+    if (m_seekInFlight && !exact) {
+        m_pendingSeek = target;
+        return;
+    }
+
+    m_pendingSeek = -1;
+    m_seekInFlight = true;
+    m_seekWatchdog->start();
+    m_seekTraceStart = trace::now();
+    m_player->setPosition(target);
+}
+
+// -------------------------
+// 跳轉完成 (新影格到達或逾時)
+// -------------------------
+void timeLine::onSeekSettled()
+{
+    if (!m_seekInFlight) return;
+
+    m_seekInFlight = false;
+    m_seekWatchdog->stop();
+    trace::complete("seek", "seek", m_seekTraceStart);
+
+    if (m_pendingSeek >= 0) {
+        qint64 next = m_pendingSeek;
+        m_pendingSeek = -1;
+        m_seekInFlight = true;
+        m_seekWatchdog->start();
+        m_seekTraceStart = trace::now();
+        m_player->setPosition(next);
+    }
+}
+
+// -------------------------
+// 關鍵幀索引：讀檔，沒有則在背景建立後存檔
+// -------------------------
+void timeLine::prepareKeyframeIndex()
+{
+    m_keyframes = KeyframeIndex();
+    QString video = m_player->source().toLocalFile();
+    if (video.isEmpty() || m_saveFolder.isEmpty()) return;
+
+    QString indexFile = (video == m_sourcePath) ? m_saveFolder + "/keyframes.idx" : video + ".idx";
+    QString hash = quickMediaHash(video);
+
+    // 原始影片的索引優先取自開啟中專案的 KEYF 段落 (第一次用到時才解碼)
+    QBuffer section;
+    if (video == m_sourcePath && m_project) section.setData(m_project->section(ProjectFile::kKeyframes));
+    if ((!section.data().isEmpty() && section.open(QIODevice::ReadOnly) && m_keyframes.load(&section, hash))
+        || m_keyframes.load(indexFile, hash)) {
+        m_filmstrip->setKeyframes(m_keyframes.times());
+        m_frameCache->setKeyframes(m_keyframes.times());
+        return;
+    }
+
+    // 完成回呼會改寫專案檔：關閉視窗時由解構子取消並等待，不會在視窗銷毀後寫入
+    auto cancel = newCancelFlag();
+    m_tasks.start([=]() {
+        KeyframeIndex index = KeyframeIndex::build(video, *cancel);
+        if (*cancel) return;
+        if (!index.isEmpty()) index.save(indexFile, hash);
+
+        QMetaObject::invokeMethod(this, [=]() {
+            // 期間若已換了影片就丟棄
+            if (*cancel || m_player->source().toLocalFile() != video) return;
+            m_keyframes = index;
+            m_filmstrip->setKeyframes(m_keyframes.times());
+            m_frameCache->setKeyframes(m_keyframes.times());
+            statusBar()->showMessage(QString("關鍵幀索引：%1 個").arg(index.times().size()), 3000);
+
+            // 專案檔在建立索引前就已儲存 (例如追蹤完成時的 session.tlproj)：補寫 KEYF 段落
+            if (video != m_sourcePath || index.isEmpty() || m_projectPath.isEmpty()
+                || !QFile::exists(m_projectPath)) {
+                return;
+            }
+            QBuffer keyframes;
+            keyframes.open(QIODevice::WriteOnly);
+            if (!index.save(&keyframes, hash)) return;
+            m_project.reset();
+            const bool saved = ProjectFile::saveSection(m_projectPath, hash, ProjectFile::kKeyframes,
+                                                        keyframes.data());
+            m_project = std::make_unique<ProjectFile>();
+            if (!m_project->open(m_projectPath)) m_project.reset();
+            if (!saved) statusBar()->showMessage("⚠️ 無法將關鍵幀索引寫入專案檔", 3000);
+        }, Qt::QueuedConnection);
+    });
+}
+
+// -------------------------
+// 取樣軌跡 (線性內插)
+// -------------------------
+QPointF timeLine::samplePosition(double sec) const
+{
+    return sampleTrajectory(m_dataPoints, sec);
+}
+
+// -------------------------
+// 指定時間的預覽裁切區域
+// -------------------------
+QRectF timeLine::cameraRoiAt(double sec) const
+{
+    return m_cameraPath.roiAtTime(sec);
+}
+
+// -------------------------
+// 規劃鏡頭路徑 (整段軌跡一次)
+// -------------------------
+void timeLine::replanCameraPath()
+{
+    if (m_dataPoints.isEmpty() || m_camW <= 0 || m_camH <= 0) {
+        m_cameraPath = CameraPath();
+        return;
+    }
+
+    TRACE_SCOPE("planCameraPath", "planner");
+    PerfTimer timer("planner.ms");
+    m_cameraPath = CameraPathPlanner::plan(m_dataPoints, cameraPathParams(), plannedFrameCount());
 
-    QScrollArea *sa = qobject_cast<QScrollArea*>(m_videoContainer);
-    if (!sa) return;
+    // 暫停時立即以新路徑重繪；播放中下一張影格即採用
+    if (m_player->playbackState() != QMediaPlayer::PlayingState) m_videoWidget->refreshRoi();
+}
 
-    // 總縮放率
-    double totalScale = m_currentScale * m_manualScale;
+CameraPathParams timeLine::cameraPathParams() const
+{
+    // 總縮放率 (以 1080p 為基準，4K 影片裁切範圍等比放大)
+    const double totalScale = m_currentScale * m_manualScale * resolutionScale();
+    const double toSource = 1.0 / resolutionScale();
+
+    // 預覽窗口對應到原始影片中的裁切大小；速度限制由 1080p 換算成原始像素
+    CameraPathParams params;
+    params.roiSize         = QSizeF(m_camW / totalScale, m_camH / totalScale);
+    params.frameSize       = m_sourceSize;
+    params.fps             = m_sourceFps;
+    params.deadZone        = m_deadZone;
+    params.maxVelocity     = m_maxVelocity * toSource;
+    params.maxAcceleration = m_maxAcceleration * toSource;
+
+    // 自動縮放：ROI 高度跟著人物框；手動倍率放大時人物佔比跟著放大
+    params.autoZoom        = m_autoZoom;
+    params.subjectFill     = m_subjectFill * m_manualScale;
+    params.minRoiHeight    = kMinAutoZoomHeight * toSource;
+    return params;
+}
 
-    // 人物在縮放後影片中的像素
-    double personX = pt.x * totalScale;
-    double personY = pt.y * totalScale;
+int timeLine::plannedFrameCount() const
+{
+    return m_sourceFrames > 0 ? m_sourceFrames : qCeil(m_endTime * m_sourceFps) + 1;
+}
 
-    // 計算影片左上角位置，使人物居中
-    double camX = personX - sa->width() / 2.0;
-    double camY = personY - sa->height() / 2.0;
+// -------------------------
+// 輸出範圍 (入點 / 出點)
+// -------------------------
+ExportRange timeLine::exportRange() const
+{
+    ExportRange range;
+    range.first = qMax(0, m_markIn);
+    if (m_markOut >= range.first) range.count = m_markOut - range.first + 1;
+    return range;
+}
 
-    // 移動 VideoWidget
-    m_videoWidget->move(-camX, -camY);
+void timeLine::setExportMark(bool in, bool clear)
+{
+    if (clear) {
+        m_markIn = m_markOut = -1;
+        statusBar()->showMessage("已清除輸出範圍", 2000);
+        return;
+    }
+
+    const int frame = qRound(m_player->position() / 1000.0 * m_sourceFps);
+    if (in) {
+        m_markIn = frame;
+        if (m_markOut >= 0 && m_markOut < m_markIn) m_markOut = -1;
+    } else {
+        m_markOut = frame;
+        if (m_markIn > m_markOut) m_markIn = -1;
+    }
+
+    const auto label = [this](int f) {
+        return f < 0 ? QString("--") : QString::number(f / m_sourceFps, 'f', 2) + "s";
+    };
+    statusBar()->showMessage(QString("輸出範圍：%1 ~ %2").arg(label(m_markIn), label(m_markOut)), 3000);
 }
 
 // -------------------------
@@ -390,15 +1241,22 @@ void timeLine::onPositionChanged(qint64 position)
 // -------------------------
 void timeLine::exportCorrectedVideo()
 {
-    if (m_player->source().isEmpty() || m_dataPoints.isEmpty()) {
+    if (m_sourcePath.isEmpty() || m_dataPoints.isEmpty() || m_cameraPath.isEmpty()) {
         QMessageBox::warning(this, "錯誤", "請先載入影片和 CSV！");
         return;
     }
 
-    QString inputFile = m_player->source().toLocalFile();
-    QString saveFile  = QFileDialog::getSaveFileName(this, "儲存校正影片", "", "*.avi");
+    // 一律讀取原始影片 (預覽可能是代理檔)
+    QString inputFile = m_sourcePath;
+    QString saveFile  = QFileDialog::getSaveFileName(this, "儲存校正影片", "", kExportFilter);
     if (saveFile.isEmpty()) return;
 
+    // 有 ffmpeg 時以片段快取增量輸出；avi (MJPG) 或影格數未知時整段輸出
+    if (ExportWriter::hasFfmpeg() && m_sourceFrames > 0 && QFileInfo(saveFile).suffix().toLower() != "avi") {
+        exportSegmented(saveFile);
+        return;
+    }
+
     cv::VideoCapture cap(inputFile.toStdString());
     if (!cap.isOpened()) {
         QMessageBox::critical(this, "錯誤", "無法開啟影片！");
@@ -408,19 +1266,34 @@ void timeLine::exportCorrectedVideo()
     int width       = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
     int height      = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
     double fps      = cap.get(cv::CAP_PROP_FPS);
-    int totalFrames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
-
-    cv::VideoWriter writer(saveFile.toStdString(),
-                           cv::VideoWriter::fourcc('M','J','P','G'),
-                           fps, cv::Size(width, height));
-
-    if (!writer.isOpened()) {
-        QMessageBox::critical(this, "錯誤", "無法初始化輸出！");
+    const int sourceFrames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+
+    // 只輸出入點 / 出點之間時，影像從入點開始讀，音訊以相同秒數裁切；
+    // 影格數未知 (部分串流格式回報 0) 時保留入點 / 出點，讀到影片結尾為止 (與 MultiFormatExport::run 相同)
+    const ExportRange range = exportRange();
+    const int firstFrame = sourceFrames > 0 ? qBound(0, range.first, sourceFrames - 1) : qMax(0, range.first);
+    int endFrame = sourceFrames > 0 ? sourceFrames : std::numeric_limits<int>::max();
+    if (range.count >= 0) endFrame = qMin(endFrame, firstFrame + range.count);
+    const bool unknownLength = endFrame == std::numeric_limits<int>::max();
+    if (firstFrame > 0) cap.set(cv::CAP_PROP_POS_FRAMES, firstFrame);
+
+    // 影像經管線送進 ffmpeg，原始音軌直接封裝，一次輸出完成
+    ExportWriter writer;
+    ExportWriter::Options options;
+    options.file        = saveFile;
+    options.frameSize   = QSize(width, height);
+    options.fps         = fps;
+    options.audioSource = inputFile;
+    options.startSec    = fps > 0 ? firstFrame / fps : 0.0;
+    options.durationSec = fps > 0 && range.count >= 0 ? (endFrame - firstFrame) / fps : 0.0;
+    if (!writer.open(options)) {
+        QMessageBox::critical(this, "錯誤", "無法初始化輸出！\n" + writer.errorString());
         return;
     }
 
-    // 進度對話框
-    QProgressDialog progress("影片輸出中...", "取消", 0, totalFrames, this);
+    // 進度對話框 (長度未知時顯示忙碌狀態)
+    QProgressDialog progress("影片輸出中...", "取消", unknownLength ? 0 : firstFrame,
+                             unknownLength ? 0 : endFrame, this);
     progress.setWindowTitle("正在處理");
 
     progress.setWindowModality(Qt::ApplicationModal);
@@ -431,56 +1304,249 @@ void timeLine::exportCorrectedVideo()
         );
     progress.show();
 
-    double totalScale = m_currentScale * m_manualScale;
-    double roiW = m_camW / totalScale;
-    double roiH = m_camH / totalScale;
+    // 裁切緩衝依整段路徑最大的 ROI 配置一次 (cropView 每張影格只取子區域)；
+    // 輸出緩衝尺寸固定，resize 也不會重新配置
+    const QSizeF maxRoi = m_cameraPath.maxRoiSize();
+    cv::Mat cropBuffer(qCeil(maxRoi.height()), qCeil(maxRoi.width()), CV_8UC3);
+    cv::Mat outFrame(height, width, CV_8UC3);
 
     cv::Mat frame;
-    int frameIdx = 0;
+    int frameIdx = firstFrame;
+    bool written = true;
+    PerfMetrics &metrics = PerfMetrics::instance();
+    QElapsedTimer stage;
+    qint64 traceStart = 0;
+
+    while (frameIdx < endFrame) {
+        stage.start();
+        traceStart = trace::now();
+        if (!cap.read(frame)) break;
+        metrics.record("export.decode.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.decode", "export", traceStart);
 
-    while (cap.read(frame)) {
         if (progress.wasCanceled()) break;
-        progress.setValue(frameIdx);
+        if (!unknownLength) progress.setValue(frameIdx);
         QApplication::processEvents();
 
-        double sec = frameIdx / fps;
-        auto it = std::lower_bound(m_dataPoints.begin(), m_dataPoints.end(), sec,
-                                   [](const DataPoint &d, double t){ return d.time < t; });
-        DataPoint pt = (it == m_dataPoints.end()) ? m_dataPoints.back() : *it;
+        // 預先規劃的裁切區域，與預覽相同
+        const QRectF planned = m_cameraPath.roiAt(frameIdx);
 
-        int x1 = static_cast<int>(pt.x - roiW / 2.0);
-        int y1 = static_cast<int>(pt.y - roiH / 2.0);
+        stage.start();
+        traceStart = trace::now();
+        const cv::Mat cropped = MultiFormatExport::cropView(frame, planned, cropBuffer);
+        metrics.record("export.crop.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.crop", "export", traceStart);
 
-        cv::Mat cropped(static_cast<int>(roiH), static_cast<int>(roiW), frame.type(), cv::Scalar(0,0,0));
+        stage.start();
+        traceStart = trace::now();
+        cv::resize(cropped, outFrame, cv::Size(width, height));
+        metrics.record("export.resize.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.resize", "export", traceStart);
 
-        int srcX1 = std::max(0, x1);
-        int srcY1 = std::max(0, y1);
-        int srcX2 = std::min(width, static_cast<int>(x1 + roiW));
-        int srcY2 = std::min(height, static_cast<int>(y1 + roiH));
-        int dstX  = (x1 < 0) ? -x1 : 0;
-        int dstY  = (y1 < 0) ? -y1 : 0;
+        stage.start();
+        traceStart = trace::now();
+        written = writer.write(outFrame);
+        metrics.record("export.encode.ms", stage.nsecsElapsed() / 1.0e6);
+        trace::complete("export.encode", "export", traceStart);
+        if (!written) break;
+
+        frameIdx++;
+    }
+
+    written = writer.close() && written;
+    cap.release();
+    const bool canceled = progress.wasCanceled();
+    progress.setValue(progress.maximum());
+
+    if (!written) {
+        QMessageBox::critical(this, "錯誤", "影片輸出失敗：\n" + writer.errorString());
+    } else if ((frameIdx >= endFrame || unknownLength) && !canceled) {
+        QMessageBox::information(this, "完成", writer.hasAudio() ? "影片校正輸出完成！"
+                                                                 : "影片校正輸出完成！(無音訊)");
+    } else if (canceled) {
+        QMessageBox::warning(this, "已取消", "輸出任務已手動停止。");
+    }
+}
 
-        if (srcX2 > srcX1 && srcY2 > srcY1) {
-            frame(cv::Rect(srcX1, srcY1, srcX2 - srcX1, srcY2 - srcY1))
-            .copyTo(cropped(cv::Rect(dstX, dstY, srcX2 - srcX1, srcY2 - srcY1)));
+// -------------------------
+// 增量輸出 (片段快取)
+// -------------------------
+void timeLine::exportSegmented(const QString &file)
+{
+    SegmentedExport::Job job;
+    job.source       = m_sourcePath;
+    job.mediaHash    = quickMediaHash(m_sourcePath);
+    job.path         = m_cameraPath;
+    job.outputSize   = m_sourceSize;
+    job.fps          = m_sourceFps;
+    job.sourceFrames = m_sourceFrames;
+    job.range        = exportRange();
+    job.file         = file;
+
+    // 片段切點需要原始影片的關鍵幀 (播放代理檔時 m_keyframes 屬於代理檔)
+    if (m_player->source().toLocalFile() == m_sourcePath) job.keyframes = m_keyframes.times();
+    const QString indexFile = m_saveFolder.isEmpty() ? QString() : m_saveFolder + "/keyframes.idx";
+
+    QProgressDialog *progress = new QProgressDialog("影片輸出中...", "取消", 0, m_sourceFrames, this);
+    progress->setWindowTitle("正在處理");
+    progress->setWindowModality(Qt::ApplicationModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setStyleSheet(
+        "QProgressDialog { color: black; }"
+        "QLabel { color: black; }"
+        );
+    progress->show();
+
+    auto cancel = newCancelFlag();
+    connect(progress, &QProgressDialog::canceled, this, [cancel]() { *cancel = true; });
+
+    QPointer<QProgressDialog> dialog(progress);
+    m_tasks.start([=]() mutable {
+        if (job.keyframes.isEmpty()) {
+            KeyframeIndex index;
+            if (indexFile.isEmpty() || !index.load(indexFile, job.mediaHash)) index = KeyframeIndex::build(job.source, *cancel);
+            job.keyframes = index.times();
         }
 
-        cv::Mat outFrame;
-        cv::resize(cropped, outFrame, cv::Size(width, height));
-        writer.write(outFrame);
+        auto onProgress = [=](int done, int total) {
+            QMetaObject::invokeMethod(this, [=]() {
+                if (!dialog) return;
+                dialog->setMaximum(total);
+                dialog->setValue(done);
+            }, Qt::QueuedConnection);
+        };
+
+        SegmentedExport::Stats stats;
+        QString error;
+        const bool ok = SegmentedExport::run(job, onProgress, *cancel, &stats, &error);
+        SegmentedExport::prune(kSegmentCacheBudget);
+
+        QMetaObject::invokeMethod(this, [=]() {
+            if (dialog) dialog->close();
+            if (ok) {
+                QMessageBox::information(this, "完成", QString("影片校正輸出完成！\n重新輸出 %1 段，沿用 %2 段")
+                                                           .arg(stats.rendered).arg(stats.reused));
+            } else if (*cancel) {
+                QMessageBox::warning(this, "已取消", error);
+            } else {
+                QMessageBox::critical(this, "錯誤", "影片輸出失敗：\n" + error);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
 
-        frameIdx++;
+// -------------------------
+// 裁切腳本附檔 (外部 ffmpeg 輸出用)
+// -------------------------
+void timeLine::exportCropScript()
+{
+    if (m_sourcePath.isEmpty() || m_cameraPath.isEmpty()) {
+        QMessageBox::warning(this, "錯誤", "請先載入影片和 CSV！");
+        return;
     }
 
-    writer.release();
-    cap.release();
-    progress.setValue(totalFrames);
+    // 預設放在原始影片旁，副檔名決定格式
+    const QFileInfo source(m_sourcePath);
+    const QString sendCmdFilter = "ffmpeg sendcmd 腳本 (*.cmd)";
+    const QString binaryFilter  = "二進位裁切清單 (*.tlcrop)";
+    QString selected = sendCmdFilter;
+    const QString path = QFileDialog::getSaveFileName(this, "輸出裁切腳本",
+                                                      source.absolutePath() + "/" + source.completeBaseName() + ".crop.cmd",
+                                                      sendCmdFilter + ";;" + binaryFilter, &selected);
+    if (path.isEmpty()) return;
+    const bool binary = path.endsWith(".tlcrop", Qt::CaseInsensitive)
+                        || (selected == binaryFilter && !path.endsWith(".cmd", Qt::CaseInsensitive));
+
+    QSaveFile file(path);
+    const bool ok = file.open(binary ? QIODevice::WriteOnly : QIODevice::WriteOnly | QIODevice::Text)
+                    && (binary ? CropScript::writeBinary(&file, m_cameraPath, m_sourceSize)
+                               : CropScript::writeSendCmd(&file, m_cameraPath, m_sourceSize, m_sourceSize,
+                                                          source.fileName()))
+                    && file.commit();
+    if (!ok) {
+        QMessageBox::critical(this, "錯誤", "無法寫入裁切腳本：\n" + path);
+        return;
+    }
+    statusBar()->showMessage(QString("已輸出裁切腳本 (%1 影格)：%2").arg(m_cameraPath.frameCount()).arg(path), 5000);
+}
 
-    if (frameIdx >= totalFrames && !progress.wasCanceled()) {
-        QMessageBox::information(this, "完成", "影片校正輸出完成！");
-    } else if (progress.wasCanceled()) {
-        QMessageBox::warning(this, "已取消", "輸出任務已手動停止。");
+// -------------------------
+// 多比例輸出 (一次解碼)
+// -------------------------
+void timeLine::exportMultiFormat()
+{
+    if (m_sourcePath.isEmpty() || m_dataPoints.isEmpty() || m_cameraPath.isEmpty()) {
+        QMessageBox::warning(this, "錯誤", "請先載入影片和 CSV！");
+        return;
     }
+
+    const QString baseFile = QFileDialog::getSaveFileName(this, "儲存校正影片 (自動加上比例後綴)", "", kExportFilter);
+    if (baseFile.isEmpty()) return;
+    const QFileInfo base(baseFile);
+    const QString stem = base.absolutePath() + "/" + base.completeBaseName();
+    const QString suffix = base.suffix().isEmpty() ? QString("mp4") : base.suffix();
+
+    // 各版本保留預覽的裁切高度 (人物大小一致)，只改變寬高比
+    struct Aspect { const char *name; double ratio; };
+    const Aspect aspects[] = { { "16x9", 16.0 / 9.0 }, { "9x16", 9.0 / 16.0 }, { "1x1", 1.0 } };
+
+    const CameraPathParams baseParams = cameraPathParams();
+    const int frames = plannedFrameCount();
+    QVector<ExportFormat> formats;
+    for (const Aspect &aspect : aspects) {
+        CameraPathParams params = baseParams;
+        params.roiSize = QSizeF(baseParams.roiSize.height() * aspect.ratio, baseParams.roiSize.height());
+
+        ExportFormat format;
+        format.name       = aspect.name;
+        format.outputSize = MultiFormatExport::outputSize(m_sourceSize, aspect.ratio);
+        format.path       = CameraPathPlanner::plan(m_dataPoints, params, frames);
+        format.file       = stem + "_" + aspect.name + "." + suffix;
+        formats.append(format);
+    }
+
+    QProgressDialog *progress = new QProgressDialog("多比例輸出中...", "取消", 0, frames, this);
+    progress->setWindowTitle("正在處理");
+    progress->setWindowModality(Qt::ApplicationModal);
+    progress->setMinimumDuration(0);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setStyleSheet(
+        "QProgressDialog { color: black; }"
+        "QLabel { color: black; }"
+        );
+    progress->show();
+
+    auto cancel = newCancelFlag();
+    connect(progress, &QProgressDialog::canceled, this, [cancel]() { *cancel = true; });
+
+    const QString source = m_sourcePath;
+    const ExportRange range = exportRange();
+    QPointer<QProgressDialog> dialog(progress);
+    m_tasks.start([=]() {
+        auto onProgress = [=](int done, int total) {
+            QMetaObject::invokeMethod(this, [=]() {
+                if (!dialog) return;
+                if (total > 0) dialog->setMaximum(total);
+                dialog->setValue(done);
+            }, Qt::QueuedConnection);
+        };
+
+        QString error;
+        const bool ok = MultiFormatExport::run(source, formats, range, onProgress, *cancel, &error);
+
+        QMetaObject::invokeMethod(this, [=]() {
+            if (dialog) dialog->close();
+            if (ok) {
+                QMessageBox::information(this, "完成", QString("已輸出 %1 個版本：\n%2_*.%3")
+                                                           .arg(formats.size()).arg(stem, suffix));
+            } else if (*cancel) {
+                QMessageBox::warning(this, "已取消", error);
+            } else {
+                QMessageBox::critical(this, "錯誤", error);
+            }
+        }, Qt::QueuedConnection);
+    });
 }
 
 // -------------------------
@@ -490,16 +1556,18 @@ void timeLine::applyManualAdjust()
 {
     m_manualScale = m_sliderScale->value() / 100.0;
 
-    if (!m_videoContainer || !m_videoWidget) return;
+    if (!m_videoWidget) return;
+    if (!m_scaleInput.isValid()) m_scaleInput.start();
 
-    double totalScale = m_currentScale * m_manualScale;
-    int videoW = static_cast<int>(1920 * totalScale);
-    int videoH = static_cast<int>(1080 * totalScale);
+    // 縮放只改變 ROI 大小，不動 Widget 幾何。
+    // 多次輸入合併成一次路徑規劃；播放中下一張影格即採用新路徑，暫停時立即重繪
+    if (m_scaleRefreshPending) return;
 
-    m_videoWidget->setFixedSize(videoW, videoH);
-
-    // 立即重新計算人物位置
-    onPositionChanged(m_player->position());
+    m_scaleRefreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_scaleRefreshPending = false;
+        replanCameraPath();
+    });
 }
 
 
@@ -8,23 +8,26 @@
 #include <QVector>
 #include <QPushButton>
 #include <QLabel>
-#include <QScrollArea>
+#include <QCheckBox>
+#include <QElapsedTimer>
 #include <opencv2/opencv.hpp>
 #include "ClickableVideoWidget.h"
 #include "VisualMap.h"
-
-// -----------------------------
-// 基礎數據結構
-// -----------------------------
-/**
- * @brief DataPoint
- * 單個數據點，包含時間與位置
- */
-struct DataPoint {
-    double time;  ///< 時間 (秒)
-    double x;     ///< x 座標
-    double y;     ///< y 座標
-};
+#include "FilmstripWidget.h"
+#include "KeyframeIndex.h"
+#include "FrameCache.h"
+#include "MediaStore.h"
+#include "ProjectFile.h"
+#include "PerfHud.h"
+#include "Trace.h"
+#include "Trajectory.h"
+#include "CameraPathPlanner.h"
+#include "MultiFormatExport.h"
+#include "LiveTracker.h"
+#include <QMultiHash>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
 
 // -----------------------------
 // timeLine 主視窗類別
@@ -39,48 +42,146 @@ public:
      */
     explicit timeLine(QWidget *parent = nullptr);
 
+    /**
+     * @brief Destructor
+     * 背景工作完成時會回呼視窗：先取消並等待 m_tasks 中的工作，才能安全解構
+     */
+    ~timeLine() override;
+
 private slots:
     void togglePlayPause();                  ///< 播放或暫停影片
     void loadFile();                         ///< 執行 Python 追蹤腳本並載入影片
+    void toggleLiveTracking(bool on);        ///< 即時追蹤：播放中逐格偵測並寫入軌跡
+    void onLiveDetection(qint64 timeUs, const QRectF &box, const QSize &frameSize); ///< 即時追蹤結果寫入軌跡
+    void correctTrackingAt(const QPoint &pos); ///< Ctrl + 點擊預覽校正追蹤：從該影格重新追蹤到與原軌跡收斂
     void loadCSV(const QString &csvFile);    ///< 讀取 CSV 數據
     void loadFileAndCSV();                   ///< 直接讀取現有影片與 CSV
+    void openProject();                      ///< 開啟專案檔 (.tlproj)
+    void saveProject();                      ///< 儲存專案檔 (.tlproj)
     void applyAutoZoom();                    ///< 自動初始化縮放參數
-    void applyManualAdjust();                ///< 手動縮放滑桿更新
+    void applyManualAdjust();                ///< 手動縮放滑桿更新 (合併為每幀一次)
+    void onViewportResized(const QSize &size); ///< 預覽窗口尺寸改變
     void onPositionChanged(qint64 position);///< 播放位置變動，同步 UI
     void exportCorrectedVideo();             ///< 關鍵功能：輸出校正影片
+    void exportMultiFormat();                ///< 一次解碼同時輸出 16:9 / 9:16 / 1:1 版本
+    void exportCropScript();                 ///< 輸出裁切路徑附檔 (ffmpeg sendcmd / 二進位清單)，不處理影片
+    void requestSeek(qint64 ms, bool exact); ///< 合併跳轉請求，拖曳中對齊關鍵幀
+    void onSeekSettled();                    ///< 跳轉完成 (新影格到達)，執行最新的待處理跳轉
+    void stepFrame(int delta);               ///< 逐格前進 / 後退 (由影格快取提供)
+    void shuttleReverse();                   ///< J：反向穿梭，重複按加速
+    void shuttlePause();                     ///< K：停止播放與穿梭
+    void shuttleForward();                   ///< L：正向播放，重複按加速
+    void onShuttleTick();                    ///< 反向穿梭計時器
 
 private:
     // -----------------------------
     // 核心數學邏輯
     // -----------------------------
     /**
-     * @brief RoiResult
-     * 記錄裁切區域資訊
+     * @brief 依目前軌跡、縮放與預覽尺寸重新規劃逐幀裁切區域 (m_cameraPath)
+     * 預覽與輸出都只讀取規劃結果，不再逐幀計算 ROI
+     */
+    void replanCameraPath();
+
+    /**
+     * @brief 目前設定下的鏡頭路徑規劃參數 (裁切大小對應預覽窗口)
+     */
+    CameraPathParams cameraPathParams() const;
+
+    /**
+     * @brief 規劃路徑的影格數 (影格數未知時由片長推算)
+     */
+    int plannedFrameCount() const;
+
+    /**
+     * @brief 輸出範圍：入點 / 出點之間 (未設定時為整支影片)
+     */
+    ExportRange exportRange() const;
+
+    /**
+     * @brief 設定入點 (I) / 出點 (O) 為目前播放位置；clear 為 true 時清除兩者
+     */
+    void setExportMark(bool in, bool clear = false);
+
+    /**
+     * @brief 以片段快取增量輸出 (背景執行)：只重新輸出裁切有變動的片段
+     * @param file 輸出檔 (非 avi，需要 ffmpeg)
+     */
+    void exportSegmented(const QString &file);
+
+    /**
+     * @brief 套用軌跡：更新時間軸範圍並從起點自動播放
+     */
+    void setTrajectory(const QVector<DataPoint> &points);
+
+    /**
+     * @brief 取樣軌跡：在前後兩個數據點之間線性內插
+     * @param sec 影片時間 (秒)
+     * @return 該時間的人物座標
+     */
+    QPointF samplePosition(double sec) const;
+
+    /**
+     * @brief 指定時間的預覽裁切區域 (原始影片座標，取自 m_cameraPath)
+     * @param sec 影片時間 (秒)
+     * @return 裁切矩形；尚未規劃時回傳空矩形 (顯示整張影格)
+     */
+    QRectF cameraRoiAt(double sec) const;
+
+    /**
+     * @brief 解析度換算：軌跡與輸出使用原始影片座標，縮放以 1080p 為基準
+     * @return 1080 / 原始影片短邊；尺寸未知時為 1
+     */
+    double resolutionScale() const;
+
+    /**
+     * @brief 開啟影片：讀取原始尺寸，有代理檔就播放代理檔；
+     * 4K 等大影片沒有代理檔時在背景產生，完成後自動切換
+     * @param video 原始影片路徑
      */
-    struct RoiResult {
-        double x1, y1; ///< 左上角座標
-        double w, h;   ///< 寬度與高度
-    };
+    void openMedia(const QString &video);
 
     /**
-     * @brief 計算 ROI (Region of Interest)
-     * @param centerX 中心 X 座標
-     * @param centerY 中心 Y 座標
-     * @return RoiResult 裁切區域資訊
+     * @brief 建立 m_tasks 工作的取消旗標 (解構時一併設為 true)
      */
-    RoiResult calculateROI(double centerX, double centerY);
+    std::shared_ptr<std::atomic_bool> newCancelFlag();
+
+    /**
+     * @brief 播放來源切換為代理檔，保留播放位置與狀態
+     */
+    void switchToProxy(const QString &proxy);
+
+    /**
+     * @brief 載入或在背景建立關鍵幀索引 (目前播放來源)
+     * 原始影片存放於 m_saveFolder/keyframes.idx，代理檔存放於代理檔旁
+     */
+    void prepareKeyframeIndex();
+
+    /**
+     * @brief 顯示快取中的影格並同步時間軸；尚未解碼時等待 frameReady
+     */
+    void showCachedFrame(int index);
+
+    /**
+     * @brief 離開逐格模式：讓播放器跳到目前影格，之後由播放器供應畫面
+     */
+    void leaveStepMode();
 
     // -----------------------------
     // 多媒體與 UI 元件
     // -----------------------------
     QMediaPlayer *m_player;                 ///< 媒體播放器
     QAudioOutput *m_audioOutput;            ///< 音訊輸出
-    ClickableVideoWidget *m_videoWidget;    ///< 可點擊的影片顯示區
-    QWidget *m_videoContainer;              ///< 影片容器 Widget
+    ClickableVideoWidget *m_videoWidget;    ///< 可點擊的 ROI 影片預覽區
     VisualMap *m_visualMap;                 ///< 可視化地圖 (追蹤顯示)
+    FilmstripWidget *m_filmstrip;           ///< 時間軸上方的縮圖膠卷
     QSlider *m_timeSlider;                  ///< 時間軸滑桿
     QSlider *m_sliderScale;                 ///< 縮放比例滑桿
+    QCheckBox *m_chkAutoZoom;               ///< 自動縮放開關
     QPushButton *m_btnPlayPause;            ///< 播放/暫停按鈕
+    QPushButton *m_btnLive;                 ///< 即時追蹤開關
+    QLabel *m_lblLatency;                   ///< 狀態列：影格到畫面更新延遲
+    PerfHud *m_perfOverlay;                 ///< 預覽畫面上的效能疊加 (F3)
 
     // -----------------------------
     // 數據與參數
@@ -92,6 +193,54 @@ private:
     double m_manualScale = 1.0;             ///< 手動調整倍率
     int m_camW = 0, m_camH = 0;             ///< 預覽窗口尺寸
     QString m_saveFolder;                    ///< 校正影片輸出資料夾
+    QString m_projectPath;                  ///< 目前專案檔路徑，空字串表示尚未存成專案
+    std::unique_ptr<ProjectFile> m_project; ///< 開啟中的專案檔 (保持映射，段落在第一次用到時才解碼)
+    MediaStore *m_mediaStore;               ///< 以雜湊定址的影片庫 (save/media)
+    QMultiHash<QString, QString> m_pendingLinks; ///< 影片雜湊 → 等待連結到存檔資料夾的路徑
+    QHash<QString, QString> m_storedMedia;  ///< 影片雜湊 → 影片庫中的路徑 (以完整內容雜湊定址)
+    QString m_sourcePath;                   ///< 原始影片路徑 (播放來源可能是代理檔)
+    QSize m_sourceSize;                     ///< 原始影片尺寸
+    double m_sourceFps = 30.0;              ///< 原始影片幀率
+    int m_sourceFrames = 0;                 ///< 原始影片影格數 (未知時為 0)
+    int m_markIn = -1, m_markOut = -1;      ///< 輸出入點 / 出點 (原始影片影格，-1 表示未設定)
+    CameraPath m_cameraPath;                ///< 逐幀裁切區域 (預覽與輸出共用)
+    double m_deadZone = 0.08;               ///< 鏡頭死區 (ROI 寬高比例)
+    double m_maxVelocity = 1500;            ///< 鏡頭最大速度 (1080p 像素/秒)
+    double m_maxAcceleration = 6000;        ///< 鏡頭最大加速度 (1080p 像素/秒²)
+    bool m_autoZoom = false;                ///< 依人物框大小自動縮放
+    double m_subjectFill = 0.45;            ///< 自動縮放時人物框高度佔 ROI 高度的比例
+    std::shared_ptr<std::atomic_bool> m_proxyCancel; ///< 進行中的代理檔產生工作
+    QThreadPool m_tasks;                    ///< 視窗擁有的背景工作 (回呼視窗的工作都在這裡執行)
+    QVector<std::weak_ptr<std::atomic_bool>> m_cancelFlags; ///< m_tasks 工作的取消旗標 (解構時全部設為 true)
+    double m_latencyAvg = 0;                ///< 延遲的指數移動平均 (毫秒)
+    double m_latencyMax = 0;                ///< 顯示區間內的最大延遲 (毫秒)
+    qint64 m_latencyShownAt = 0;            ///< 上次更新延遲顯示的時間
+    QElapsedTimer m_scaleInput;             ///< 第一個尚未顯示的縮放輸入時間
+    bool m_scaleRefreshPending = false;     ///< 已排程一次縮放更新
+
+    // -----------------------------
+    // 跳轉 / 拖曳
+    // -----------------------------
+    KeyframeIndex m_keyframes;              ///< 目前影片的關鍵幀索引
+    qint64 m_pendingSeek = -1;              ///< 等待中的跳轉目標 (只保留最新一筆)
+    bool m_seekInFlight = false;            ///< 是否有跳轉尚未完成
+    qint64 m_seekTraceStart = 0;            ///< 目前跳轉的追蹤起點 (trace::now)
+    QTimer *m_seekWatchdog;                 ///< 跳轉逾時保護，避免沒有新影格時卡住
+
+    // -----------------------------
+    // 逐格 / J-K-L 穿梭
+    // -----------------------------
+    FrameCache *m_frameCache;               ///< 已解碼影格環狀快取
+    int m_stepFrame = -1;                   ///< 逐格模式目前影格，-1 表示由播放器顯示
+    int m_shuttleSpeed = 0;                 ///< 穿梭速度：負值反向，正值正向 (倍率)
+    QTimer *m_shuttleTimer;                 ///< 反向穿梭計時器
+
+    // -----------------------------
+    // 即時追蹤
+    // -----------------------------
+    LiveTracker *m_liveTracker;             ///< 播放器影格 → 追蹤執行緒
+    QTimer *m_liveReplan;                   ///< 合併即時結果的鏡頭路徑重新規劃 (限制裁切跟隨延遲)
+    bool m_correcting = false;              ///< 點擊校正進行中 (一次只執行一個，完成回呼才清除)
 };
 
 #endif // TIMELINE_H
@@ -0,0 +1,131 @@
+# bench_tracker.py
+# 追蹤引擎準確度與速度回歸測試：
+# 以固定影片集與參考軌跡 (time_sec,x,y,w,h) 執行追蹤，輸出可與基準比對 (diff) 的 JSON
+#   python bench_tracker.py --manifest regression/manifest.example.json --output result.json
+#   python bench_tracker.py --manifest regression/manifest.example.json --baseline regression/baseline.json
+import argparse
+import json
+import os
+import sys
+import tempfile
+
+from metrics import compare_trajectories, load_trajectory, percentile
+from track import create_detector, track_video
+
+# 指標方向：True 表示越大越好；比對基準時用來判斷是否退步
+METRIC_HIGHER_IS_BETTER = {
+    'fps': True,
+    'latency_p50_ms': False,
+    'latency_p95_ms': False,
+    'latency_p99_ms': False,
+    'mean_center_error': False,
+    'mean_iou': True,
+    'id_switches': False,
+}
+
+
+def run_clip(clip, detector, motion_threshold, motion_max_skip, base_dir):
+    """執行單支影片並計算指標"""
+    video = os.path.join(base_dir, clip['video'])
+    reference = os.path.join(base_dir, clip['reference'])
+
+    latencies = []
+    with tempfile.TemporaryDirectory() as tmp:
+        out_csv = os.path.join(tmp, 'tracking.csv')
+        stats = track_video(video, out_csv, motion_threshold=motion_threshold,
+                            motion_max_skip=motion_max_skip, detector=detector, latencies=latencies)
+        if stats is None:
+            return None
+        accuracy = compare_trajectories(load_trajectory(reference), load_trajectory(out_csv))
+
+    lat_ms = [v * 1000.0 for v in latencies]
+    result = {
+        'frames': stats['frames'],
+        'skipped': stats['skipped'],
+        'fps': stats['frames'] / stats['total_sec'] if stats['total_sec'] > 0 else 0.0,
+        'latency_p50_ms': percentile(lat_ms, 50),
+        'latency_p95_ms': percentile(lat_ms, 95),
+        'latency_p99_ms': percentile(lat_ms, 99),
+    }
+    result.update(accuracy)
+    return result
+
+
+def compare_to_baseline(current, baseline, tolerance):
+    """
+    逐影片逐指標與基準比較，回傳退步清單
+    tolerance 為相對容許誤差 (例如 0.05 = 5%)
+    """
+    regressions = []
+    for name, metrics in current['clips'].items():
+        base = baseline.get('clips', {}).get(name)
+        if base is None:
+            continue
+        for key, higher_better in METRIC_HIGHER_IS_BETTER.items():
+            if key not in metrics or key not in base:
+                continue
+            cur, ref = metrics[key], base[key]
+            margin = abs(ref) * tolerance
+            worse = cur < ref - margin if higher_better else cur > ref + margin
+            if worse:
+                regressions.append({'clip': name, 'metric': key, 'baseline': ref, 'current': cur})
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="追蹤引擎準確度與速度回歸測試")
+    parser.add_argument("--manifest", required=True, help="影片集 JSON (clips: [{name, video, reference}])")
+    parser.add_argument("--output", help="結果 JSON 輸出路徑 (預設印在 stdout)")
+    parser.add_argument("--baseline", help="與之比較的基準結果 JSON")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="基準比較的相對容許誤差")
+    parser.add_argument("--runtime", choices=['torch', 'onnx'], default='torch')
+    parser.add_argument("--precision", choices=['fp32', 'int8'], default='fp32')
+    parser.add_argument("--model", help="ONNX 模型路徑")
+    parser.add_argument("--motion-threshold", type=float, default=2.0)
+    parser.add_argument("--motion-max-skip", type=int, default=15)
+    args = parser.parse_args()
+
+    with open(args.manifest) as f:
+        manifest = json.load(f)
+    base_dir = os.path.dirname(os.path.abspath(args.manifest))
+
+    detector = create_detector(args.runtime, args.precision, args.model)
+    result = {
+        'detector': detector.name,
+        'motion_threshold': args.motion_threshold,
+        'motion_max_skip': args.motion_max_skip,
+        'clips': {},
+    }
+
+    for clip in manifest['clips']:
+        name = clip.get('name', clip['video'])
+        metrics = run_clip(clip, detector, args.motion_threshold, args.motion_max_skip, base_dir)
+        if metrics is None:
+            print(f"Error: 影片執行失敗: {name}")
+            sys.exit(1)
+        result['clips'][name] = metrics
+        print(f"{name}: {metrics['fps']:.1f} fps, p95 {metrics['latency_p95_ms']:.1f} ms, "
+              f"center err {metrics['mean_center_error']:.1f}px, IoU {metrics['mean_iou']:.3f}, "
+              f"ID switches {metrics['id_switches']}")
+
+    text = json.dumps(result, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text + '\n')
+    else:
+        print(text)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare_to_baseline(result, baseline, args.tolerance)
+        for r in regressions:
+            print(f"REGRESSION {r['clip']} {r['metric']}: {r['baseline']:.4g} -> {r['current']:.4g}")
+        if regressions:
+            sys.exit(2)
+        print("No regressions against baseline.")
+
+
+if __name__ == "__main__":
+    main()
+    sys.exit(0)
@@ -0,0 +1,84 @@
+# calibrate_int8.py
+# 以自家影片抽樣的畫面做靜態量化校正，將 YOLOv5 FP32 ONNX 轉為 INT8
+#
+# FP32 模型可用 yolov5 官方匯出：
+#   python export.py --weights yolov5s.pt --include onnx --imgsz 640
+# 再執行：
+#   python calibrate_int8.py --fp32 models/yolov5s.onnx --clips a.mp4 b.mp4
+import argparse
+import os
+import sys
+
+import cv2
+
+from track import DEFAULT_ONNX, letterbox
+
+
+def sample_frames(clips, per_clip, input_size):
+    """每支影片等間距抽取 per_clip 張畫面，回傳前處理後的 blob 清單"""
+    blobs = []
+    for clip in clips:
+        cap = cv2.VideoCapture(clip)
+        if not cap.isOpened():
+            print(f"Warning: 無法開啟影片，略過: {clip}")
+            continue
+
+        total = int(cap.get(cv2.CAP_PROP_FRAME_COUNT))
+        step = max(total // per_clip, 1)
+        for idx in range(0, step * per_clip, step):
+            cap.set(cv2.CAP_PROP_POS_FRAMES, idx)
+            ret, frame = cap.read()
+            if not ret:
+                break
+            blobs.append(letterbox(frame, input_size)[0])
+        cap.release()
+        print(f"{clip}: 已抽樣，累計 {len(blobs)} 張")
+    return blobs
+
+
+def main():
+    parser = argparse.ArgumentParser(description="YOLOv5 ONNX INT8 靜態量化校正工具")
+    parser.add_argument("--fp32", default=DEFAULT_ONNX['fp32'], help="FP32 ONNX 模型路徑")
+    parser.add_argument("--output", default=DEFAULT_ONNX['int8'], help="輸出 INT8 ONNX 路徑")
+    parser.add_argument("--clips", nargs='+', required=True, help="用來抽樣校正畫面的影片")
+    parser.add_argument("--samples-per-clip", type=int, default=32, help="每支影片抽樣張數")
+    parser.add_argument("--imgsz", type=int, default=640, help="模型輸入尺寸")
+    parser.add_argument("--per-channel", action="store_true", help="權重逐通道量化 (較準確)")
+    args = parser.parse_args()
+
+    from onnxruntime.quantization import (CalibrationDataReader, QuantFormat, QuantType,
+                                          quantize_static)
+    import onnxruntime as ort
+
+    if not os.path.exists(args.fp32):
+        print(f"Error: FP32 模型不存在: {args.fp32}")
+        sys.exit(1)
+
+    input_name = ort.InferenceSession(args.fp32, providers=['CPUExecutionProvider']).get_inputs()[0].name
+    blobs = sample_frames(args.clips, args.samples_per_clip, args.imgsz)
+    if not blobs:
+        print("Error: 沒有可用的校正畫面")
+        sys.exit(1)
+
+    class ClipReader(CalibrationDataReader):
+        """逐張提供校正輸入"""
+
+        def __init__(self):
+            self.it = iter(blobs)
+
+        def get_next(self):
+            blob = next(self.it, None)
+            return None if blob is None else {input_name: blob}
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    quantize_static(args.fp32, args.output, ClipReader(),
+                    quant_format=QuantFormat.QDQ,
+                    activation_type=QuantType.QUInt8,
+                    weight_type=QuantType.QInt8,
+                    per_channel=args.per_channel)
+    print(f"INT8 model saved to {args.output} ({len(blobs)} calibration frames)")
+
+
+if __name__ == "__main__":
+    main()
+    sys.exit(0)
@@ -0,0 +1,71 @@
+# compare_models.py
+# 以同一支影片分別跑 FP32 與 INT8 偵測器，輸出速度與軌跡差異報告
+#   python compare_models.py --input clip.mp4 --report report.json
+import argparse
+import json
+import os
+import sys
+
+from metrics import compare_trajectories, load_trajectory
+from track import create_detector, track_video
+
+
+def run(video, runtime, precision, model, out_csv, threads):
+    """執行一次追蹤 (關閉動態閘門，確保每幀都推論)，回傳統計資料"""
+    detector = create_detector(runtime, precision, model, threads)
+    stats = track_video(video, out_csv, motion_threshold=0, detector=detector)
+    if stats is None:
+        sys.exit(1)
+    frames = max(stats['inferred'], 1)
+    return {
+        'detector': stats['detector'],
+        'csv': out_csv,
+        'frames': stats['frames'],
+        'fps': stats['frames'] / stats['total_sec'] if stats['total_sec'] > 0 else 0.0,
+        'infer_ms_per_frame': stats['infer_sec'] * 1000.0 / frames,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="FP32 / INT8 偵測器準確度與速度比較")
+    parser.add_argument("--input", required=True, help="輸入影片路徑")
+    parser.add_argument("--baseline-runtime", choices=['torch', 'onnx'], default='onnx',
+                        help="FP32 基準使用的推論後端")
+    parser.add_argument("--fp32-model", help="FP32 ONNX 模型路徑")
+    parser.add_argument("--int8-model", help="INT8 ONNX 模型路徑")
+    parser.add_argument("--workdir", default=".", help="輸出 CSV 的資料夾")
+    parser.add_argument("--threads", type=int, default=0, help="onnxruntime 執行緒數，0 為自動")
+    parser.add_argument("--report", help="將報告寫成 JSON 的路徑")
+    args = parser.parse_args()
+
+    stem = os.path.splitext(os.path.basename(args.input))[0]
+    fp32_csv = os.path.join(args.workdir, f"{stem}.fp32.csv")
+    int8_csv = os.path.join(args.workdir, f"{stem}.int8.csv")
+
+    fp32 = run(args.input, args.baseline_runtime, 'fp32', args.fp32_model, fp32_csv, args.threads)
+    int8 = run(args.input, 'onnx', 'int8', args.int8_model, int8_csv, args.threads)
+
+    accuracy = compare_trajectories(load_trajectory(fp32_csv), load_trajectory(int8_csv))
+    report = {
+        'video': args.input,
+        'fp32': fp32,
+        'int8': int8,
+        'speedup': int8['fps'] / fp32['fps'] if fp32['fps'] > 0 else 0.0,
+        'int8_vs_fp32': accuracy,
+    }
+
+    print(f"{'':10}{'fps':>10}{'ms/frame':>12}")
+    for key in ('fp32', 'int8'):
+        print(f"{key:10}{report[key]['fps']:>10.1f}{report[key]['infer_ms_per_frame']:>12.1f}")
+    print(f"speedup: {report['speedup']:.2f}x")
+    print(f"center error: mean {accuracy['mean_center_error']:.1f}px / p95 {accuracy['p95_center_error']:.1f}px, "
+          f"mean IoU {accuracy['mean_iou']:.3f}, missed {accuracy['missed']}, extra {accuracy['extra']}")
+
+    if args.report:
+        with open(args.report, 'w') as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
+    sys.exit(0)
@@ -0,0 +1,95 @@
+# metrics.py
+# 軌跡 CSV (time_sec,x,y,w,h) 的讀取與比對工具，供模型比較與回歸測試共用
+import csv
+import math
+
+
+def load_trajectory(csv_path):
+    """
+    讀取追蹤 CSV，回傳 {time_sec: (x, y, w, h)}
+    時間以毫秒整數為 key，避免浮點誤差造成對不上
+    """
+    rows = {}
+    with open(csv_path, newline='') as f:
+        reader = csv.reader(f)
+        for row in reader:
+            if len(row) < 5:
+                continue
+            try:
+                t, x, y, w, h = (float(v) for v in row[:5])
+            except ValueError:
+                continue  # 標題列
+            rows[int(round(t * 1000))] = (x, y, w, h)
+    return rows
+
+
+def to_box(row):
+    """中心點格式 (x, y, w, h) 轉為 (x1, y1, x2, y2)"""
+    x, y, w, h = row
+    return x - w / 2, y - h / 2, x + w / 2, y + h / 2
+
+
+def iou(a, b):
+    """兩個中心點格式框的 IoU"""
+    ax1, ay1, ax2, ay2 = to_box(a)
+    bx1, by1, bx2, by2 = to_box(b)
+    iw = max(0.0, min(ax2, bx2) - max(ax1, bx1))
+    ih = max(0.0, min(ay2, by2) - max(ay1, by1))
+    inter = iw * ih
+    union = a[2] * a[3] + b[2] * b[3] - inter
+    return inter / union if union > 0 else 0.0
+
+
+def center_error(a, b):
+    """兩框中心點的歐氏距離 (像素)"""
+    return math.hypot(a[0] - b[0], a[1] - b[1])
+
+
+def percentile(values, p):
+    """線性內插百分位數，values 為空時回傳 0"""
+    if not values:
+        return 0.0
+    s = sorted(values)
+    k = (len(s) - 1) * p / 100.0
+    lo, hi = int(math.floor(k)), int(math.ceil(k))
+    return s[lo] + (s[hi] - s[lo]) * (k - lo)
+
+
+def compare_trajectories(reference, candidate, match_iou=0.5):
+    """
+    以 reference 為準逐時間點比對 candidate，回傳準確度指標：
+    - mean/p95 center error、mean IoU (只計算雙方都有結果的時間點)
+    - missed / extra：只有一方有結果的時間點數
+    - id_switches：單目標追蹤下，候選框從「對上參考目標」跳到「對不上但仍有偵測」的次數
+    """
+    errors, ious = [], []
+    missed = extra = id_switches = 0
+    prev_matched = None
+
+    for t in sorted(set(reference) | set(candidate)):
+        ref, cand = reference.get(t), candidate.get(t)
+        if ref is None:
+            extra += 1
+            continue
+        if cand is None:
+            missed += 1
+            continue
+
+        errors.append(center_error(ref, cand))
+        overlap = iou(ref, cand)
+        ious.append(overlap)
+
+        matched = overlap >= match_iou
+        if prev_matched is True and not matched:
+            id_switches += 1
+        prev_matched = matched
+
+    return {
+        'matched_frames': len(errors),
+        'missed': missed,
+        'extra': extra,
+        'mean_center_error': sum(errors) / len(errors) if errors else 0.0,
+        'p95_center_error': percentile(errors, 95),
+        'mean_iou': sum(ious) / len(ious) if ious else 0.0,
+        'id_switches': id_switches,
+    }
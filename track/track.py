@@ -1,21 +1,197 @@
 # track_qt_with_view.py
 import argparse
 import cv2
-import torch
 import csv
+import json
 import os
 import sys
+import time
 
+import numpy as np
 
-def track_video(video_path, output_csv, show=False):
+# 預設 ONNX 模型位置 (FP32 由 yolov5 export.py 匯出，INT8 由 calibrate_int8.py 產生)
+MODEL_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'models')
+DEFAULT_ONNX = {
+    'fp32': os.path.join(MODEL_DIR, 'yolov5s.onnx'),
+    'int8': os.path.join(MODEL_DIR, 'yolov5s-int8.onnx'),
+}
+PERSON_CLASS_ID = 0  # COCO 類別 0 = person
+
+
+def letterbox(frame, size=640):
+    """
+    YOLOv5 前處理：等比例縮放並補邊到 size x size，回傳 (NCHW float32 blob, 縮放比例, (pad_x, pad_y))
+    校正工具與 ONNX 偵測器共用，確保量化校正時的輸入分布與推論一致
+    """
+    h, w = frame.shape[:2]
+    r = min(size / w, size / h)
+    new_w, new_h = int(round(w * r)), int(round(h * r))
+    pad_x, pad_y = (size - new_w) // 2, (size - new_h) // 2
+
+    resized = cv2.resize(frame, (new_w, new_h), interpolation=cv2.INTER_LINEAR)
+    canvas = np.full((size, size, 3), 114, dtype=np.uint8)
+    canvas[pad_y:pad_y + new_h, pad_x:pad_x + new_w] = resized
+
+    blob = cv2.cvtColor(canvas, cv2.COLOR_BGR2RGB).transpose(2, 0, 1)[None].astype(np.float32) / 255.0
+    return np.ascontiguousarray(blob), r, (pad_x, pad_y)
+
+
+class TorchDetector:
+    """torch.hub YOLOv5 (FP32)，有 GPU 時使用 GPU"""
+
+    def __init__(self):
+        import torch
+        # 載入 YOLOv5 模型 (優先使用 GPU，若無則用 CPU)
+        device = torch.device('cuda' if torch.cuda.is_available() else 'cpu')
+        self.model = torch.hub.load('ultralytics/yolov5', 'yolov5s', pretrained=True).to(device)
+        self.name = f"torch-fp32-{device.type}"
+
+    def detect(self, frame):
+        """回傳置信度最高的人 (x1, y1, x2, y2, conf)，沒有則回傳 None"""
+        results = self.model(frame)
+        detections = results.pandas().xyxy[0]
+        persons = detections[detections['name'] == 'person']
+        if len(persons) == 0:
+            return None
+
+        # 策略：選取置信度 (confidence) 最高的人，或您可以改為選取面積最大的
+        person = persons.sort_values(by="confidence", ascending=False).iloc[0]
+        return (int(person['xmin']), int(person['ymin']), int(person['xmax']), int(person['ymax']),
+                float(person['confidence']))
+
+
+class OnnxDetector:
+    """onnxruntime CPU 推論，可載入 FP32 或 INT8 量化的 YOLOv5 ONNX 模型"""
+
+    def __init__(self, model_path, precision, input_size=640, conf_threshold=0.25, threads=0):
+        import onnxruntime as ort
+        if not os.path.exists(model_path):
+            raise FileNotFoundError(f"ONNX 模型不存在: {model_path}")
+
+        opts = ort.SessionOptions()
+        opts.graph_optimization_level = ort.GraphOptimizationLevel.ORT_ENABLE_ALL
+        if threads > 0:
+            opts.intra_op_num_threads = threads
+        self.session = ort.InferenceSession(model_path, opts, providers=['CPUExecutionProvider'])
+        self.input_name = self.session.get_inputs()[0].name
+        self.input_size = input_size
+        self.conf_threshold = conf_threshold
+        self.name = f"onnx-{precision}-cpu"
+
+    def detect(self, frame):
+        """回傳置信度最高的人 (x1, y1, x2, y2, conf)，沒有則回傳 None"""
+        blob, r, (pad_x, pad_y) = letterbox(frame, self.input_size)
+        pred = self.session.run(None, {self.input_name: blob})[0][0]  # (N, 5 + classes)
+
+        # 只需要單一最佳目標，因此取 obj * cls 最大者即可，不必做 NMS
+        scores = pred[:, 4] * pred[:, 5 + PERSON_CLASS_ID]
+        best = int(np.argmax(scores))
+        conf = float(scores[best])
+        if conf < self.conf_threshold:
+            return None
+
+        cx, cy, bw, bh = pred[best, :4]
+        h, w = frame.shape[:2]
+        x1 = int(np.clip((cx - bw / 2 - pad_x) / r, 0, w - 1))
+        y1 = int(np.clip((cy - bh / 2 - pad_y) / r, 0, h - 1))
+        x2 = int(np.clip((cx + bw / 2 - pad_x) / r, 0, w - 1))
+        y2 = int(np.clip((cy + bh / 2 - pad_y) / r, 0, h - 1))
+        return x1, y1, x2, y2, conf
+
+
+def create_detector(runtime='torch', precision='fp32', model_path=None, threads=0):
+    """
+    依執行模式建立偵測器
+    runtime=torch 只支援 fp32；runtime=onnx 可切換 fp32 / int8
+    """
+    if runtime == 'torch':
+        if precision != 'fp32':
+            raise ValueError("torch 執行模式只支援 fp32，INT8 請使用 --runtime onnx")
+        return TorchDetector()
+    return OnnxDetector(model_path or DEFAULT_ONNX[precision], precision, threads=threads)
+
+
+class MotionGate:
+    """
+    低成本動態閘門：在推論前以降採樣灰階幀差 (區塊 SAD) 判斷畫面是否有明顯變化。
+    與「上一次實際推論的幀」比較，緩慢漂移也會被累積偵測到。
+    """
+
+    def __init__(self, threshold, max_skip=15, size=(160, 90), blocks=(16, 9)):
+        self.threshold = threshold  # 區塊平均絕對差的門檻 (0~255)，<= 0 表示停用
+        self.max_skip = max_skip    # 連續略過上限，避免長時間沿用舊結果
+        self.size = size            # 降採樣尺寸
+        self.blocks = blocks        # 區塊格數 (寬, 高)
+        self.ref = None             # 上一次推論時的參考灰階影像
+        self.skipped_run = 0
+        self.last_score = 0.0
+
+    def changed(self, frame):
+        """回傳 True 表示需要重新推論"""
+        if self.threshold <= 0:
+            return True
+
+        small = cv2.resize(frame, self.size, interpolation=cv2.INTER_AREA)
+        gray = cv2.cvtColor(small, cv2.COLOR_BGR2GRAY)
+
+        if self.ref is None or self.skipped_run >= self.max_skip:
+            self.ref = gray
+            self.skipped_run = 0
+            return True
+
+        # 區塊 SAD：以 INTER_AREA 縮到區塊格數即為每區塊平均差，取最大值，
+        # 避免畫面中小範圍的移動被整張平均稀釋
+        diff = cv2.absdiff(gray, self.ref)
+        block_sad = cv2.resize(diff, self.blocks, interpolation=cv2.INTER_AREA)
+        self.last_score = float(block_sad.max())
+
+        if self.last_score < self.threshold:
+            self.skipped_run += 1
+            return False
+
+        self.ref = gray
+        self.skipped_run = 0
+        return True
+
+
+class TraceRecorder:
+    """
+    收集 Chrome trace 事件 (complete event)，格式與 Qt 端 --trace 相同，
+    可在 Perfetto 中與主程式的追蹤檔一起開啟
+    """
+
+    def __init__(self):
+        self.t0 = time.perf_counter()
+        self.events = []
+
+    def span(self, name, start):
+        """記錄從 start (time.perf_counter) 到現在的一段事件"""
+        end = time.perf_counter()
+        self.events.append({'name': name, 'cat': 'tracker', 'ph': 'X', 'pid': 2, 'tid': 1,
+                            'ts': (start - self.t0) * 1e6, 'dur': (end - start) * 1e6})
+
+    def save(self, path):
+        meta = {'name': 'process_name', 'ph': 'M', 'pid': 2, 'args': {'name': 'track.py'}}
+        with open(path, 'w') as f:
+            json.dump({'displayTimeUnit': 'ms', 'traceEvents': [meta] + self.events}, f)
+
+
+def track_video(video_path, output_csv, show=False, motion_threshold=2.0, motion_max_skip=15,
+                detector=None, latencies=None, tracer=None):
+    """
+    逐幀偵測並寫出 CSV，回傳統計資料 dict (失敗時回傳 None)
+    detector 為 None 時使用 torch FP32 偵測器
+    latencies 若為 list，會依序附加每幀處理時間 (秒，不含解碼)
+    tracer 若為 TraceRecorder，記錄每幀解碼、動態閘門與推論的時間區段
+    """
     if not os.path.exists(video_path):
         print(f"Error: 影片不存在: {video_path}")
-        return
+        return None
 
     cap = cv2.VideoCapture(video_path)
     if not cap.isOpened():
         print(f"Error: 無法開啟影片: {video_path}")
-        return
+        return None
 
     fps = cap.get(cv2.CAP_PROP_FPS)
     # 取得影片原始尺寸，用於確保座標不越界
@@ -23,39 +199,78 @@ def track_video(video_path, output_csv, show=False):
     height = int(cap.get(cv2.CAP_PROP_FRAME_HEIGHT))
 
     # -----------------------------
-    # 載入 YOLOv5 模型 (優先使用 GPU，若無則用 CPU)
-    device = torch.device('cuda' if torch.cuda.is_available() else 'cpu')
-    model = torch.hub.load('ultralytics/yolov5', 'yolov5s', pretrained=True).to(device)
-    target_class = 'person'
+    # 載入偵測器 (預設 torch FP32)
+    if detector is None:
+        detector = create_detector()
+
+    gate = MotionGate(motion_threshold, motion_max_skip)
+    stats = {
+        'frames': 0,            # 總幀數
+        'inferred': 0,          # 實際執行 YOLO 的幀數
+        'skipped': 0,           # 被動態閘門略過的幀數
+        'carried_rows': 0,      # 沿用上一筆偵測結果寫出的列數
+        'infer_sec': 0.0,       # 推論累計時間
+        'total_sec': 0.0,       # 整體處理時間
+        'motion_threshold': motion_threshold,
+        'motion_max_skip': motion_max_skip,
+        'detector': detector.name,
+    }
+    last_row = None  # 上一次推論得到的 (center_x, center_y, w, h)
+    t_start = time.perf_counter()
 
     # -----------------------------
     # 初始化 CSV
     with open(output_csv, mode='w', newline='') as csv_file:
         csv_writer = csv.writer(csv_file)
-        # 欄位保持與 Qt 端一致
-        csv_writer.writerow(['time_sec', 'x', 'y', 'w', 'h'])
+        # 欄位保持與 Qt 端一致，carried=1 表示該列沿用前一次偵測結果
+        csv_writer.writerow(['time_sec', 'x', 'y', 'w', 'h', 'carried'])
 
         frame_idx = 0
         while True:
+            t_read = time.perf_counter()
             ret, frame = cap.read()
             if not ret:
                 break
+            if tracer is not None:
+                tracer.span('decode', t_read)
 
             frame_idx += 1
             time_sec = frame_idx / fps
+            stats['frames'] += 1
+            t_frame = time.perf_counter()
 
             # -----------------------------
-            # 每幀偵測邏輯：解決 CSRT 漂移問題
+            # 動態閘門：畫面沒有明顯變化時沿用上一筆結果
             # -----------------------------
-            results = model(frame)
-            detections = results.pandas().xyxy[0]
-            persons = detections[detections['name'] == target_class]
+            t_gate = time.perf_counter()
+            changed = gate.changed(frame)
+            if tracer is not None:
+                tracer.span('motion_gate', t_gate)
+            if not changed:
+                stats['skipped'] += 1
+                if last_row is not None:
+                    csv_writer.writerow([round(time_sec, 3), *last_row, 1])
+                    stats['carried_rows'] += 1
+                if latencies is not None:
+                    latencies.append(time.perf_counter() - t_frame)
+                if show:
+                    cv2.imshow("Detection Tracking", frame)
+                    if cv2.waitKey(1) & 0xFF == ord('q'):
+                        break
+                continue
 
-            if len(persons) > 0:
-                # 策略：選取置信度 (confidence) 最高的人，或您可以改為選取面積最大的
-                person = persons.sort_values(by="confidence", ascending=False).iloc[0]
+            # -----------------------------
+            # 每幀偵測邏輯：解決 CSRT 漂移問題
+            # -----------------------------
+            t_infer = time.perf_counter()
+            person = detector.detect(frame)
+            stats['infer_sec'] += time.perf_counter() - t_infer
+            if tracer is not None:
+                tracer.span('inference', t_infer)
+            stats['inferred'] += 1
 
-                x1, y1, x2, y2 = int(person['xmin']), int(person['ymin']), int(person['xmax']), int(person['ymax'])
+            if person is not None:
+                x1, y1, x2, y2, conf = person
                 w, h = x2 - x1, y2 - y1
 
                 # 計算中心點座標 (這對 Qt 端的置中平移效果最好)
@@ -63,18 +278,22 @@ def track_video(video_path, output_csv, show=False):
                 center_y = (y1 + y2) // 2
 
                 # 寫入 CSV
-                csv_writer.writerow([round(time_sec, 3), center_x, center_y, w, h])
+                last_row = (center_x, center_y, w, h)
+                csv_writer.writerow([round(time_sec, 3), center_x, center_y, w, h, 0])
 
                 # 顯示追蹤框 (僅在 show=True 時執行)
                 if show:
                     cv2.rectangle(frame, (x1, y1), (x2, y2), (0, 255, 0), 2)
                     cv2.circle(frame, (center_x, center_y), 5, (0, 0, 255), -1)
-                    cv2.putText(frame, f"Tracking Person: {round(person['confidence'], 2)}",
+                    cv2.putText(frame, f"Tracking Person: {round(conf, 2)}",
                                 (x1, y1 - 10), cv2.FONT_HERSHEY_SIMPLEX, 0.6, (0, 255, 0), 2)
             else:
                 # 如果該幀沒偵測到人，可選擇留空或紀錄上一次位置
                 # 這裡選擇不寫入，Qt 端會維持在最後一個已知點
-                pass
+                last_row = None
+
+            if latencies is not None:
+                latencies.append(time.perf_counter() - t_frame)
 
             if show:
                 cv2.imshow("Detection Tracking", frame)
@@ -84,7 +303,23 @@ def track_video(video_path, output_csv, show=False):
     cap.release()
     if show:
         cv2.destroyAllWindows()
+
+    stats['total_sec'] = time.perf_counter() - t_start
+    print_stats(stats)
     print(f"Tracking finished. Data saved to {output_csv}")
+    return stats
+
+
+def print_stats(stats):
+    """輸出動態閘門統計，方便逐支影片比較加速效果"""
+    frames = max(stats['frames'], 1)
+    skip_ratio = stats['skipped'] / frames
+    fps = stats['frames'] / stats['total_sec'] if stats['total_sec'] > 0 else 0.0
+    print(f"Detector: {stats['detector']}")
+    print(f"Motion gate: threshold={stats['motion_threshold']} "
+          f"skipped={stats['skipped']}/{stats['frames']} ({skip_ratio:.1%}) "
+          f"carried_rows={stats['carried_rows']} "
+          f"infer={stats['infer_sec']:.2f}s total={stats['total_sec']:.2f}s ({fps:.1f} fps)")
 
 
 def main():
@@ -92,9 +327,36 @@ def main():
     parser.add_argument("--input", required=True, help="輸入影片路徑")
     parser.add_argument("--output", required=True, help="輸出 CSV 路徑")
     parser.add_argument("--show", action="store_true", help="是否顯示預覽畫面")
+    parser.add_argument("--motion-threshold", type=float, default=2.0,
+                        help="動態閘門門檻 (區塊平均灰階差 0~255)，0 表示每幀都推論")
+    parser.add_argument("--motion-max-skip", type=int, default=15,
+                        help="連續略過推論的最大幀數")
+    parser.add_argument("--stats", help="將統計資料寫成 JSON 的路徑")
+    parser.add_argument("--runtime", choices=['torch', 'onnx'], default='torch',
+                        help="推論後端：torch (可用 GPU) 或 onnx (onnxruntime CPU)")
+    parser.add_argument("--precision", choices=['fp32', 'int8'], default='fp32',
+                        help="模型精度，int8 需搭配 --runtime onnx")
+    parser.add_argument("--model", help="ONNX 模型路徑 (預設 track/models/yolov5s[-int8].onnx)")
+    parser.add_argument("--threads", type=int, default=0, help="onnxruntime 執行緒數，0 為自動")
+    parser.add_argument("--trace", help="將解碼 / 推論時間區段寫成 Chrome trace JSON 的路徑")
     args = parser.parse_args()
 
-    track_video(args.input, args.output, args.show)
+    try:
+        detector = create_detector(args.runtime, args.precision, args.model, args.threads)
+    except (ValueError, FileNotFoundError, ImportError) as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+
+    tracer = TraceRecorder() if args.trace else None
+    stats = track_video(args.input, args.output, args.show,
+                        args.motion_threshold, args.motion_max_skip, detector, tracer=tracer)
+
+    if tracer is not None:
+        tracer.save(args.trace)
+
+    if stats is not None and args.stats:
+        with open(args.stats, 'w') as f:
+            json.dump(stats, f, indent=2)
 
 
 if __name__ == "__main__":